@@ -6,6 +6,8 @@
  *  Definition of classes to be stored in the root tree.
  *  Function TCompareXYZ sorts objects by the variable XYZ that MUST be
  *  present in the data members of the root tree class of the branch.
+ *  The data members of the tree classes have to follow the lists in
+ *  ExRootSchema.h, this is checked at compile time after the classes.
  *
  *  $Date: 2007/07/23 14:35:57 $
  *  $Revision: 1.6 $
@@ -23,6 +25,10 @@
 
 #include "TMath.h"
 
+#include "ExRootAnalysis/ExRootSchema.h"
+
+#include <vector>
+
 //---------------------------------------------------------------------------
 
 class TCompare
@@ -58,6 +64,28 @@ public:
 
 //---------------------------------------------------------------------------
 
+class TRootLHEFRun: public TObject
+{
+public:
+
+  Int_t BeamPID[2]; // HEP ID numbers of the beam particles | heprup.IDBMUP
+  Double_t BeamEnergy[2]; // energies of the beam particles in GeV | heprup.EBMUP
+  Int_t PDFGroup[2]; // author groups of the beam PDFs | heprup.PDFGUP
+  Int_t PDFSet[2]; // beam PDF sets | heprup.PDFSUP
+
+  Int_t WeightingStrategy; // interpretation of the event weights | heprup.IDWTUP
+  Int_t Nprocesses; // number of subprocesses | heprup.NPRUP
+
+  std::vector<Double_t> CrossSection; // cross section of each subprocess in pb | heprup.XSECUP
+  std::vector<Double_t> CrossSectionError; // statistical error of the cross section in pb | heprup.XERRUP
+  std::vector<Double_t> MaxWeight; // maximum event weight of each subprocess | heprup.XMAXUP
+  std::vector<Int_t> ProcessID; // subprocess codes | heprup.LPRUP
+
+  ClassDef(TRootLHEFRun, 1)
+};
+
+//---------------------------------------------------------------------------
+
 class TRootLHEFEvent: public TObject
 {
 public:
@@ -327,6 +355,36 @@ public:
   ClassDef(TRootJet, 2)
 };
 
+//---------------------------------------------------------------------------
+
+EXROOT_SCHEMA_CLASSES(EXROOT_SCHEMA_CHECK)
+
+//---------------------------------------------------------------------------
+// Object reuse: objects of the classes marked kReusable hold no TRef,
+// TRefArray, pointers or containers and may be kept between events and
+// overwritten in place, see ExRootTreeWriter::NewBranch<T>
+//---------------------------------------------------------------------------
+
+template <typename T>
+struct ExRootReuseTraits
+{
+  enum { kReusable = kFALSE };
+};
+
+template <> struct ExRootReuseTraits<TRootWeight> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootLHEFEvent> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootLHEFParticle> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootGenEvent> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootGenParticle> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootGenJet> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootEvent> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootMissingET> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootPhoton> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootElectron> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootMuon> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootTau> { enum { kReusable = kTRUE }; };
+template <> struct ExRootReuseTraits<TRootJet> { enum { kReusable = kTRUE }; };
+
 //---------------------------------------------------------------------------
 // Standard Comparison Criteria: E, ET, PT, DeltaR
 //---------------------------------------------------------------------------
@@ -0,0 +1,74 @@
+#ifndef ExRootColumnReader_h
+#define ExRootColumnReader_h
+
+/** \class ExRootColumnReader
+ *
+ *  Maps a file written by ExRootColumnWriter into memory and gives
+ *  access to its columns without copying.
+ *  The spans stay valid until Close() or the destruction of the reader.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include "ExRootAnalysis/ExRootColumnWriter.h"
+#include "ExRootAnalysis/ExRootSpan.h"
+
+class ExRootColumnReader
+{
+public:
+
+  ExRootColumnReader();
+  ~ExRootColumnReader();
+
+  Bool_t Open(const char *fileName);
+  void Close();
+
+  Long64_t GetEntries() const { return fHeader ? fHeader->entries : 0; }
+
+  // index of the collection, -1 if the file does not contain it
+  Int_t GetCollection(const char *name) const;
+
+  // columns of all objects in the file
+  ExRootSpan<Float_t> GetPT(Int_t collection) const { return GetColumn<Float_t>(collection, &ExRootColumnDirectory::pt); }
+  ExRootSpan<Float_t> GetEta(Int_t collection) const { return GetColumn<Float_t>(collection, &ExRootColumnDirectory::eta); }
+  ExRootSpan<Float_t> GetPhi(Int_t collection) const { return GetColumn<Float_t>(collection, &ExRootColumnDirectory::phi); }
+  ExRootSpan<Int_t> GetBTag(Int_t collection) const { return GetColumn<Int_t>(collection, &ExRootColumnDirectory::btag); }
+
+  // columns of the objects in one event
+  ExRootSpan<Float_t> GetPT(Int_t collection, Long64_t entry) const { return GetEvent(GetPT(collection), collection, entry); }
+  ExRootSpan<Float_t> GetEta(Int_t collection, Long64_t entry) const { return GetEvent(GetEta(collection), collection, entry); }
+  ExRootSpan<Float_t> GetPhi(Int_t collection, Long64_t entry) const { return GetEvent(GetPhi(collection), collection, entry); }
+  ExRootSpan<Int_t> GetBTag(Int_t collection, Long64_t entry) const { return GetEvent(GetBTag(collection), collection, entry); }
+
+  // per-event offsets, entries + 1 values
+  ExRootSpan<Long64_t> GetOffsets(Int_t collection) const;
+
+private:
+
+  template<typename T>
+  ExRootSpan<T> GetColumn(Int_t collection, Long64_t ExRootColumnDirectory::*section) const
+  {
+    if(!fHeader || collection < 0 || collection >= Int_t(fHeader->collections)) return ExRootSpan<T>();
+    const ExRootColumnDirectory &entry = fDirectory[collection];
+    return ExRootSpan<T>(reinterpret_cast<const T *>(fData + entry.*section), entry.objects);
+  }
+
+  template<typename T>
+  ExRootSpan<T> GetEvent(ExRootSpan<T> column, Int_t collection, Long64_t entry) const
+  {
+    ExRootSpan<Long64_t> offsets = GetOffsets(collection);
+    if(entry < 0 || entry + 1 >= Long64_t(offsets.size())) return ExRootSpan<T>();
+    return ExRootSpan<T>(column.data() + offsets[entry], offsets[entry + 1] - offsets[entry]);
+  }
+
+  const char *fData;
+  size_t fSize;
+  Bool_t fMapped;
+
+  const ExRootColumnHeader *fHeader;
+  const ExRootColumnDirectory *fDirectory;
+};
+
+#endif /* ExRootColumnReader */
+
@@ -0,0 +1,85 @@
+#ifndef ExRootColumnWriter_h
+#define ExRootColumnWriter_h
+
+/** \class ExRootColumnWriter
+ *
+ *  Writes PT, Eta, Phi and BTag of reconstructed objects into a flat
+ *  columnar file that ExRootColumnReader maps into memory.
+ *
+ *  Layout: header, one directory entry per collection, then for every
+ *  collection the per-event offsets (Long64_t[entries + 1]) followed by
+ *  the PT, Eta, Phi (Float_t[objects]) and BTag (Int_t[objects]) columns.
+ *  Every section starts at a multiple of kAlignment bytes, all numbers
+ *  are stored in the byte order of the machine that wrote the file.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <string>
+#include <vector>
+
+struct ExRootColumnHeader
+{
+  enum {kVersion = 1, kByteOrder = 0x01020304};
+
+  char magic[8]; // "ExRootC"
+  UInt_t version;
+  UInt_t byteOrder;
+  UInt_t collections;
+  UInt_t reserved;
+  Long64_t entries;
+};
+
+struct ExRootColumnDirectory
+{
+  enum {kNameSize = 32};
+
+  char name[kNameSize];
+  Long64_t objects;
+  // positions of the sections in bytes from the beginning of the file
+  Long64_t offsets, pt, eta, phi, btag;
+};
+
+class ExRootColumnWriter
+{
+public:
+
+  enum {kAlignment = 64};
+
+  ExRootColumnWriter(const char *fileName);
+  ~ExRootColumnWriter();
+
+  Int_t NewCollection(const char *name);
+
+  void Add(Int_t collection, Float_t pt, Float_t eta, Float_t phi, Int_t btag = 0)
+  {
+    Collection &data = fCollections[collection];
+    data.pt.push_back(pt);
+    data.eta.push_back(eta);
+    data.phi.push_back(phi);
+    data.btag.push_back(btag);
+  }
+
+  void Fill();
+  // returns kFALSE if the file could not be written
+  Bool_t Write();
+
+private:
+
+  struct Collection
+  {
+    std::string name;
+    std::vector<Long64_t> offsets;
+    std::vector<Float_t> pt, eta, phi;
+    std::vector<Int_t> btag;
+  };
+
+  std::string fFileName;
+  Long64_t fEntries;
+
+  std::vector<Collection> fCollections;
+};
+
+#endif /* ExRootColumnWriter */
+
@@ -0,0 +1,94 @@
+#ifndef ExRootColumns_h
+#define ExRootColumns_h
+
+/** \class ExRootColumns
+ *
+ *  Column views (one vector per data member) of the classes listed in
+ *  ExRootSchema.h, generated for every class as <class>Columns.
+ *
+ *  Add copies objects into the columns, Write creates the objects of an
+ *  output branch from the columns, Get copies one row back into an object.
+ *  The columns can be processed without virtual calls, e.g. by loops that
+ *  the compiler vectorizes, GetFields describes them for other backends.
+ *
+ */
+
+#include "Rtypes.h"
+#include "TClonesArray.h"
+
+#include "ExRootAnalysis/ExRootClasses.h"
+#include "ExRootAnalysis/ExRootSchema.h"
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+
+#include <vector>
+
+//---------------------------------------------------------------------------
+
+// type code of a data member, as in the leaf list of TTree::Branch
+
+template <typename T> struct ExRootLeafType;
+
+template <> struct ExRootLeafType<Int_t> { static char Code() { return 'I'; } };
+template <> struct ExRootLeafType<Long64_t> { static char Code() { return 'L'; } };
+template <> struct ExRootLeafType<Float_t> { static char Code() { return 'F'; } };
+template <> struct ExRootLeafType<Double_t> { static char Code() { return 'D'; } };
+
+struct ExRootSchemaField
+{
+  const char *name;
+  char type;
+  const char *title;
+};
+
+//---------------------------------------------------------------------------
+
+#define EXROOT_COLUMN_DECLARE(type, name, title) std::vector<type> name;
+#define EXROOT_COLUMN_CLEAR(type, name, title) name.clear();
+#define EXROOT_COLUMN_RESERVE(type, name, title) name.reserve(size);
+#define EXROOT_COLUMN_ADD(type, name, title) name.push_back(object.name);
+#define EXROOT_COLUMN_GET(type, name, title) object.name = name[row];
+#define EXROOT_COLUMN_FIELD(type, name, title) {#name, ExRootLeafType<type>::Code(), title},
+
+#define EXROOT_COLUMNS(cls, name) \
+class cls##Columns \
+{ \
+public: \
+  EXROOT_SCHEMA_##cls(EXROOT_COLUMN_DECLARE) \
+\
+  cls##Columns() : fSize(0) {} \
+\
+  size_t Size() const { return fSize; } \
+\
+  void Clear() { EXROOT_SCHEMA_##cls(EXROOT_COLUMN_CLEAR) fSize = 0; } \
+  void Reserve(size_t size) { EXROOT_SCHEMA_##cls(EXROOT_COLUMN_RESERVE) } \
+\
+  void Add(const cls &object) { EXROOT_SCHEMA_##cls(EXROOT_COLUMN_ADD) ++fSize; } \
+\
+  void Add(const TClonesArray *array) \
+  { \
+    Int_t i, entries = array->GetEntriesFast(); \
+    for(i = 0; i < entries; ++i) Add(*static_cast<const cls *>(array->UncheckedAt(i))); \
+  } \
+\
+  void Get(size_t row, cls &object) const { EXROOT_SCHEMA_##cls(EXROOT_COLUMN_GET) } \
+\
+  void Write(ExRootTreeBranch *branch) const \
+  { \
+    size_t row; \
+    for(row = 0; row < fSize; ++row) Get(row, *static_cast<cls *>(branch->NewEntry())); \
+  } \
+\
+  /* terminated by an entry with name 0 */ \
+  static const ExRootSchemaField *GetFields() \
+  { \
+    static const ExRootSchemaField fields[] = { EXROOT_SCHEMA_##cls(EXROOT_COLUMN_FIELD) {0, 0, 0} }; \
+    return fields; \
+  } \
+\
+private: \
+  size_t fSize; \
+};
+
+EXROOT_SCHEMA_CLASSES(EXROOT_COLUMNS)
+
+#endif /* ExRootColumns */
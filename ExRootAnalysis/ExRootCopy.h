@@ -0,0 +1,67 @@
+#ifndef ExRootCopy_h
+#define ExRootCopy_h
+
+/** \class ExRootCopy
+ *
+ *  Copies data members between the tree classes and the plain structures
+ *  of ExRootStructs.h:
+ *
+ *  ExRootCopy(object, structure) and ExRootCopy(structure, object) for
+ *  single objects, ExRootCopy(array, structures) fills a vector from a
+ *  TClonesArray read from a tree and ExRootCopy(structures, branch)
+ *  creates the objects of an output branch.
+ *
+ */
+
+#include "TClonesArray.h"
+
+#include "ExRootAnalysis/ExRootClasses.h"
+#include "ExRootAnalysis/ExRootStructs.h"
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+
+#include <vector>
+
+//---------------------------------------------------------------------------
+
+// tree class of a plain structure
+template <typename T> struct ExRootStructTraits;
+
+#define EXROOT_COPY_MEMBER(type, name, title) to.name = from.name;
+
+#define EXROOT_COPY(cls, name) \
+template <> struct ExRootStructTraits<ExRoot##name> { typedef cls Class; }; \
+inline void ExRootCopy(const cls &from, ExRoot##name &to) { EXROOT_SCHEMA_##cls(EXROOT_COPY_MEMBER) } \
+inline void ExRootCopy(const ExRoot##name &from, cls &to) { EXROOT_SCHEMA_##cls(EXROOT_COPY_MEMBER) }
+
+EXROOT_SCHEMA_CLASSES(EXROOT_COPY)
+
+//---------------------------------------------------------------------------
+
+template <typename T>
+void ExRootCopy(const TClonesArray *array, std::vector<T> &structures)
+{
+  typedef typename ExRootStructTraits<T>::Class Class;
+  Int_t i, entries = array->GetEntriesFast();
+
+  structures.resize(entries);
+  for(i = 0; i < entries; ++i)
+  {
+    ExRootCopy(*static_cast<const Class *>(array->UncheckedAt(i)), structures[i]);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+template <typename T>
+void ExRootCopy(const std::vector<T> &structures, ExRootTreeBranch *branch)
+{
+  typedef typename ExRootStructTraits<T>::Class Class;
+  typename std::vector<T>::const_iterator itStructures;
+
+  for(itStructures = structures.begin(); itStructures != structures.end(); ++itStructures)
+  {
+    ExRootCopy(*itStructures, *static_cast<Class *>(branch->NewEntry()));
+  }
+}
+
+#endif /* ExRootCopy */
@@ -0,0 +1,86 @@
+#ifndef ExRootEventSinks_h
+#define ExRootEventSinks_h
+
+/** \class ExRootEventSinks
+ *
+ *  Pipeline sinks (ExRootPipeline.h) writing the events of
+ *  ExRootLHEFSource and ExRootSTDHEPSource into the branches of an
+ *  ExRootTreeWriter. Write() copies and fills one event, derived classes
+ *  can call Copy() and Fill() separately, e.g. to time them.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+#include "ExRootAnalysis/ExRootEventSources.h"
+
+class ExRootTreeWriter;
+class ExRootTreeBranch;
+
+//---------------------------------------------------------------------------
+
+class ExRootLHEFTreeSink: public ExRootSink<ExRootLHEFEventData>
+{
+public:
+
+  // the branches are created from the weight storage of the reader,
+  // the run information and the weight IDs are taken from the reader
+  // with the first event
+  ExRootLHEFTreeSink(ExRootTreeWriter *treeWriter, ExRootLHEFReader *reader);
+
+  Bool_t Write(ExRootLHEFEventData &data);
+
+  void Copy(ExRootLHEFEventData &data);
+  void Fill();
+
+  // the next event is the first one of a new output file
+  void Reset() { fEventCounter = 0; }
+
+  Long64_t GetEvents() const { return fEventCounter; }
+
+private:
+
+  void WriteHeader();
+
+  ExRootTreeWriter *fTreeWriter;
+  ExRootLHEFReader *fReader;
+
+  ExRootTreeBranch *fBranchEvent, *fBranchRwgt, *fBranchParticle;
+
+  // the weight array leaf reads from these copies,
+  // the reader is already busy with the next events
+  std::vector<Double_t> fWeightDouble;
+  std::vector<Float_t> fWeightFloat;
+
+  Long64_t fEventCounter;
+};
+
+//---------------------------------------------------------------------------
+
+class ExRootSTDHEPTreeSink: public ExRootSink<ExRootSTDHEPEventData>
+{
+public:
+
+  ExRootSTDHEPTreeSink(ExRootTreeWriter *treeWriter);
+
+  Bool_t Write(ExRootSTDHEPEventData &data);
+
+  void Copy(ExRootSTDHEPEventData &data);
+  void Fill();
+
+  void Reset() { fEventCounter = 0; }
+
+  Long64_t GetEvents() const { return fEventCounter; }
+
+private:
+
+  ExRootTreeWriter *fTreeWriter;
+
+  ExRootTreeBranch *fBranchGenEvent, *fBranchGenParticle;
+
+  Long64_t fEventCounter;
+};
+
+#endif /* ExRootEventSinks */
@@ -0,0 +1,87 @@
+#ifndef ExRootEventSources_h
+#define ExRootEventSources_h
+
+/** \class ExRootEventSources
+ *
+ *  Pipeline sources (ExRootPipeline.h) reading events with
+ *  ExRootLHEFReader and ExRootSTDHEPReader. Every event owns a copy of
+ *  its particles and weights, so it can be transformed and written while
+ *  the reader goes on with the next events.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+#include "ExRootAnalysis/ExRootStructs.h"
+#include "ExRootAnalysis/ExRootPipeline.h"
+
+class ExRootLHEFReader;
+class ExRootSTDHEPReader;
+
+//---------------------------------------------------------------------------
+
+struct ExRootLHEFEventData
+{
+  ExRootLHEFEvent event;
+  std::vector<ExRootLHEFParticle> particles;
+
+  // weights of <rwgt> with ExRootLHEFReader::kWeightObjects,
+  // the weight array in the order of <initrwgt> otherwise
+  std::vector<ExRootWeight> weights;
+  std::vector<Double_t> weightDouble;
+  std::vector<Float_t> weightFloat;
+};
+
+struct ExRootSTDHEPEventData
+{
+  ExRootLHEFEvent event;
+  std::vector<ExRootGenParticle> particles;
+};
+
+//---------------------------------------------------------------------------
+
+class ExRootLHEFSource: public ExRootSource<ExRootLHEFEventData>
+{
+public:
+
+  ExRootLHEFSource(ExRootLHEFReader *reader);
+
+  Bool_t Read(ExRootLHEFEventData &data);
+
+  // time spent in the reader, in ExRootTimer cycles
+  ULong64_t GetCycles() const { return fCycles; }
+  Long64_t GetEvents() const { return fEventCounter; }
+
+private:
+
+  ExRootLHEFReader *fReader;
+
+  Long64_t fEventCounter;
+  ULong64_t fCycles;
+};
+
+//---------------------------------------------------------------------------
+
+class ExRootSTDHEPSource: public ExRootSource<ExRootSTDHEPEventData>
+{
+public:
+
+  ExRootSTDHEPSource(ExRootSTDHEPReader *reader);
+
+  Bool_t Read(ExRootSTDHEPEventData &data);
+
+  // time spent in the reader, in ExRootTimer cycles
+  ULong64_t GetCycles() const { return fCycles; }
+  Long64_t GetEvents() const { return fEventCounter; }
+
+private:
+
+  ExRootSTDHEPReader *fReader;
+
+  Long64_t fEventCounter;
+  ULong64_t fCycles;
+};
+
+#endif /* ExRootEventSources */
@@ -0,0 +1,49 @@
+#ifndef ExRootEventView_h
+#define ExRootEventView_h
+
+/** \class ExRootEventView
+ *
+ *  Events returned by ExRootLHEFReader::ReadEvent and
+ *  ExRootSTDHEPReader::ReadEvent or passed to an ExRootEventHandler.
+ *  The views point into buffers of the reader that are reused for every
+ *  event, they stay valid until the next event is read.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include "ExRootAnalysis/ExRootSpan.h"
+#include "ExRootAnalysis/ExRootStructs.h"
+
+struct ExRootLHEFEventView
+{
+  const ExRootLHEFEvent *event;
+  ExRootSpan<ExRootLHEFParticle> particles;
+
+  // weights in the order of <rwgt> with ExRootLHEFReader::kWeightObjects,
+  // in the order of <initrwgt> with kWeightDouble, empty with kWeightFloat
+  ExRootSpan<double> weights;
+
+  // weights in the order of <initrwgt> with kWeightFloat, empty otherwise
+  ExRootSpan<float> weightsFloat;
+};
+
+struct ExRootSTDHEPEventView
+{
+  const ExRootLHEFEvent *event;
+  ExRootSpan<ExRootGenParticle> particles;
+};
+
+//---------------------------------------------------------------------------
+
+template <typename T>
+class ExRootEventHandler
+{
+public:
+  virtual ~ExRootEventHandler() {}
+
+  // returns kFALSE to stop reading
+  virtual Bool_t ProcessEvent(const T &event) = 0;
+};
+
+#endif /* ExRootEventView */
@@ -0,0 +1,76 @@
+#ifndef ExRootInputStream_h
+#define ExRootInputStream_h
+
+/** \class ExRootInputStream
+ *
+ *  Reads a plain, gzip or zstd compressed file on a separate thread and
+ *  hands the decompressed data out in large blocks.
+ *  The format is recognized from the first bytes of the file, gzip files
+ *  may consist of several members and zstd files of several frames.
+ *  zstd support needs HAVE_ZSTD (make ZSTD=1).
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class ExRootInputStream
+{
+public:
+
+  enum EFormat {kPlain, kGzip, kZstd};
+
+  enum {kBlockSize = 4*1024*1024, kBlocks = 4, kInputSize = 1024*1024};
+
+  ExRootInputStream(FILE *inputFile);
+  ~ExRootInputStream();
+
+  // gives the previous block back to the decoder and returns the next one,
+  // the caller may modify the data in place,
+  // kFALSE at the end of the input or after an error
+  Bool_t NextBlock(char *&data, size_t &size);
+
+  // description of the error that ended the input, empty if none
+  const std::string &GetError() const { return fError; }
+
+private:
+
+  struct Block
+  {
+    std::vector<char> data;
+    size_t size;
+  };
+
+  void Decode();
+  void DecodePlain(const char *input, size_t size);
+  void DecodeGzip(char *input, size_t size);
+  void DecodeZstd(char *input, size_t size);
+
+  Block *AcquireBlock();
+  void PublishBlock(Block *block);
+  void SetError(const std::string &error);
+
+  FILE *fInputFile;
+
+  std::vector<Block> fBlocks;
+  std::deque<Block *> fFree, fReady;
+  Block *fCurrent;
+
+  Bool_t fFinished, fStop;
+  std::string fError;
+
+  std::mutex fMutex;
+  std::condition_variable fFreeCondition, fReadyCondition;
+  std::thread fThread;
+};
+
+#endif /* ExRootInputStream */
+
@@ -17,19 +17,35 @@
 #include <stdio.h>
 
 #include <vector>
+#include <string>
+
+#include "ExRootAnalysis/ExRootStructs.h"
+#include "ExRootAnalysis/ExRootEventView.h"
 
 class ExRootTreeBranch;
 class ExRootFactory;
+class TRootLHEFRun;
+class ExRootInputStream;
 
 class ExRootLHEFReader
 {
 public:
 
+  // kWeightObjects stores one TRootWeight per weight, kWeightDouble and
+  // kWeightFloat fill a fixed-width array with one value per weight
+  // declared in <initrwgt>
+  enum EWeightStorage {kWeightObjects, kWeightDouble, kWeightFloat};
+
   ExRootLHEFReader();
   ~ExRootLHEFReader();
 
+  // plain, gzip or zstd compressed input, decompressed on a separate
+  // thread, SetInputFile(0) stops reading before the file is closed
   void SetInputFile(FILE *inputFile);
 
+  void SetWeightStorage(EWeightStorage storage) { fWeightStorage = storage; }
+  EWeightStorage GetWeightStorage() const { return fWeightStorage; }
+
   void Clear();
   bool EventReady();
 
@@ -39,13 +55,59 @@ public:
 
   void AnalyzeRwgt(ExRootTreeBranch *branch);
 
+  // the same with plain structures instead of branches (ExRootStructs.h),
+  // the particles and weights are appended to the vectors
+  bool ReadBlock(std::vector<ExRootLHEFParticle> &particles);
+  void AnalyzeEvent(ExRootLHEFEvent &event, long long eventNumber);
+  void AnalyzeRwgt(std::vector<ExRootWeight> &weights);
+
+  // reads up to the end of the next event, kFALSE at the end of the input,
+  // the view stays valid until the next event is read (ExRootEventView.h),
+  // not to be mixed with ReadBlock
+  bool ReadEvent(ExRootLHEFEventView &view);
+
+  // calls the handler for every event up to the end of the input or until
+  // it returns kFALSE, returns the number of events
+  long long ReadEvents(ExRootEventHandler<ExRootLHEFEventView> *handler);
+
+  // weight IDs from <initrwgt>, available once the first event is read
+  const std::vector<std::string> &GetWeightIDs() const { return fWeightIDs; }
+
+  // weights of the current event in the array mode, the address
+  // does not change after the header is read
+  void *GetWeightArray();
+  int GetWeightArraySize() const { return fWeightIDs.size(); }
+
+  // beams, PDFs and cross sections from <init>, 0 before </init> is read
+  const TRootLHEFRun *GetRun() const { return fInitReady ? fRun : 0; }
+
 private:
 
-  void AnalyzeParticle(ExRootTreeBranch *branch);
+  // position in the file, the lines are interpreted depending on the block
+  enum EState {kOutside, kHeader, kInitRwgt, kInit, kEvent};
+
+  bool ReadLine();
+  template <typename T> bool Read(T *output);
+  template <typename T> bool ReadEventLine(T *output);
+  bool ReadInitLine();
+  bool ReadInitRwgtLine(const char *line);
+
+  template <typename T> void FillEvent(T *element, long long eventNumber);
+  template <typename T> void FillParticle(T *element);
+  bool AnalyzeWeightID(const char *tag);
+  bool AnalyzeWeight(const char *tag);
 
   FILE *fInputFile;
 
-  char *fBuffer;
+  ExRootInputStream *fInputStream;
+  char *fBlock;
+  size_t fBlockSize, fBlockPosition;
+
+  // fLine points to the current line, either inside the block
+  // or to fBuffer if the line crosses the end of the block,
+  // fBuffer grows to the longest such line and is reused
+  std::vector<char> fBuffer;
+  char *fLine;
 
   bool fEventReady;
 
@@ -58,6 +120,21 @@ private:
   double fPx, fPy, fPz, fE, fMass, fLifeTime, fSpin;
   
   std::vector<double> fRwgtList;
+
+  EWeightStorage fWeightStorage;
+  int fWeightCounter;
+  std::vector<std::string> fWeightIDs;
+  std::vector<double> fWeightDouble;
+  std::vector<float> fWeightFloat;
+
+  std::vector<ExRootLHEFParticle> fParticles;
+  ExRootLHEFEvent fEvent;
+  long long fEventNumber;
+
+  EState fState;
+  int fProcessCounter;
+  bool fInitReady;
+  TRootLHEFRun *fRun;
 };
 
 #endif // ExRootLHEFReader_h
@@ -0,0 +1,350 @@
+#ifndef ExRootPipeline_h
+#define ExRootPipeline_h
+
+/** \class ExRootPipeline
+ *
+ *  Event loop of the form read -> transform -> write running on several
+ *  threads. The source reads events on its own thread, the transforms run
+ *  on a pool of worker threads, each worker takes the next event that is
+ *  waiting, and the sink gets the events on the thread that calls Run()
+ *  in the order of the source.
+ *
+ *  The events are kept in a ring of slots that are reused, the number of
+ *  slots bounds the number of events in flight. Source::Read has to
+ *  overwrite the whole event. The transforms are called concurrently for
+ *  different events and must not have a state of their own.
+ *  With zero threads everything runs on the calling thread.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+class ExRootSource
+{
+public:
+  virtual ~ExRootSource() {}
+
+  // kFALSE at the end of the input
+  virtual Bool_t Read(T &event) = 0;
+};
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+class ExRootTransform
+{
+public:
+  virtual ~ExRootTransform() {}
+
+  // kFALSE drops the event
+  virtual Bool_t Process(T &event) = 0;
+};
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+class ExRootSink
+{
+public:
+  virtual ~ExRootSink() {}
+
+  // kFALSE stops the pipeline
+  virtual Bool_t Write(T &event) = 0;
+};
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+class ExRootPipeline
+{
+public:
+
+  ExRootPipeline(ExRootSource<T> *source, ExRootSink<T> *sink, Int_t threads = 0, Int_t slots = 64) :
+    fSource(source), fSink(sink), fThreads(threads > 0 ? threads : 0),
+    fSlots(slots > 1 ? slots : 2), fRead(0), fProcess(0), fWrite(0),
+    fSourceDone(kFALSE), fStop(kFALSE),
+    fSourceWaiting(kFALSE), fSinkWaiting(kFALSE), fWorkersWaiting(0)
+  {
+    fBatch = fSlots.size()/4;
+  }
+
+  void AddTransform(ExRootTransform<T> *transform) { fTransforms.push_back(transform); }
+
+  // runs until the end of the input or until the sink stops it,
+  // returns the number of events written, exceptions (std::runtime_error)
+  // of the other threads are thrown again here
+  Long64_t Run();
+
+private:
+
+  enum EState {kFree, kRead, kDone, kDropped};
+
+  struct Slot
+  {
+    Slot() : state(kFree) {}
+    T event;
+    EState state;
+  };
+
+  Bool_t ProcessEvent(T &event);
+
+  void ReadEvents();
+  void ProcessEvents();
+  void Fail(const std::string &error);
+
+  ExRootSource<T> *fSource;
+  ExRootSink<T> *fSink;
+  std::vector<ExRootTransform<T> *> fTransforms;
+  Int_t fThreads;
+
+  std::vector<Slot> fSlots;
+  // sequence numbers of the next event to read, to transform and to write,
+  // event n is in slot n % fSlots.size()
+  Long64_t fRead, fProcess, fWrite;
+
+  Bool_t fSourceDone, fStop;
+  std::string fError;
+
+  // the condition variables are only signalled when somebody waits and
+  // fBatch events are ready for it, most events pass without a system call
+  Bool_t fSourceWaiting, fSinkWaiting;
+  Int_t fWorkersWaiting;
+  Long64_t fBatch;
+
+  std::mutex fMutex;
+  std::condition_variable fFreeCondition, fWorkCondition, fDoneCondition;
+};
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+Bool_t ExRootPipeline<T>::ProcessEvent(T &event)
+{
+  typename std::vector<ExRootTransform<T> *>::iterator itTransforms;
+
+  for(itTransforms = fTransforms.begin(); itTransforms != fTransforms.end(); ++itTransforms)
+  {
+    if(!(*itTransforms)->Process(event)) return kFALSE;
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+void ExRootPipeline<T>::Fail(const std::string &error)
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    if(fError.empty()) fError = error;
+    fStop = kTRUE;
+  }
+  fFreeCondition.notify_all();
+  fWorkCondition.notify_all();
+  fDoneCondition.notify_all();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+void ExRootPipeline<T>::ReadEvents()
+{
+  Long64_t size = fSlots.size();
+  Slot *slot;
+  Bool_t good, work, done;
+
+  try
+  {
+    while(true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        while(!fStop && fRead - fWrite >= size)
+        {
+          fSourceWaiting = kTRUE;
+          fFreeCondition.wait(lock);
+          fSourceWaiting = kFALSE;
+        }
+        if(fStop) return;
+        slot = &fSlots[fRead % size];
+      }
+
+      // the slot is not visible to the other threads before fRead moves on
+      good = fSource->Read(slot->event);
+
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if(good)
+        {
+          slot->state = fTransforms.empty() ? kDone : kRead;
+          ++fRead;
+        }
+        else
+        {
+          fSourceDone = kTRUE;
+        }
+        work = fWorkersWaiting > 0 && fRead - fProcess >= fBatch;
+        done = fSinkWaiting && fTransforms.empty() && fRead - fWrite >= fBatch;
+      }
+
+      if(!good)
+      {
+        fWorkCondition.notify_all();
+        fDoneCondition.notify_one();
+        return;
+      }
+
+      if(work) fWorkCondition.notify_all();
+      if(done) fDoneCondition.notify_one();
+    }
+  }
+  catch(std::runtime_error &e)
+  {
+    Fail(e.what());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+void ExRootPipeline<T>::ProcessEvents()
+{
+  Long64_t size = fSlots.size();
+  Slot *slot;
+  Bool_t keep, done;
+
+  try
+  {
+    while(true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        while(!fStop && !fSourceDone && fProcess == fRead)
+        {
+          ++fWorkersWaiting;
+          fWorkCondition.wait(lock);
+          --fWorkersWaiting;
+        }
+        if(fStop || fProcess == fRead) return;
+        slot = &fSlots[fProcess % size];
+        ++fProcess;
+      }
+
+      keep = ProcessEvent(slot->event);
+
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        slot->state = keep ? kDone : kDropped;
+        // the sink waits for the oldest event
+        done = fSinkWaiting && fSlots[fWrite % size].state != kRead &&
+          (fSourceDone || fProcess - fWrite >= fBatch);
+      }
+      if(done) fDoneCondition.notify_one();
+    }
+  }
+  catch(std::runtime_error &e)
+  {
+    Fail(e.what());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+Long64_t ExRootPipeline<T>::Run()
+{
+  Long64_t size = fSlots.size(), written = 0;
+  std::vector<std::thread> workers;
+  std::thread reader;
+  Slot *slot;
+  Bool_t good = kTRUE, free;
+  Int_t i;
+
+  if(fThreads == 0)
+  {
+    T &event = fSlots[0].event;
+    while(fSource->Read(event))
+    {
+      if(!ProcessEvent(event)) continue;
+      ++written;
+      if(!fSink->Write(event)) break;
+    }
+    return written;
+  }
+
+  fRead = fProcess = fWrite = 0;
+  fSourceDone = fStop = kFALSE;
+  fSourceWaiting = fSinkWaiting = kFALSE;
+  fWorkersWaiting = 0;
+  fError.clear();
+
+  reader = std::thread(&ExRootPipeline<T>::ReadEvents, this);
+  if(!fTransforms.empty())
+  {
+    for(i = 0; i < fThreads; ++i) workers.push_back(std::thread(&ExRootPipeline<T>::ProcessEvents, this));
+  }
+
+  try
+  {
+    while(good)
+    {
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        while(!fStop && (fWrite == fRead ? !fSourceDone : fSlots[fWrite % size].state == kRead))
+        {
+          fSinkWaiting = kTRUE;
+          fDoneCondition.wait(lock);
+          fSinkWaiting = kFALSE;
+        }
+        if(fStop || fWrite == fRead) break;
+        slot = &fSlots[fWrite % size];
+      }
+
+      if(slot->state == kDone)
+      {
+        ++written;
+        good = fSink->Write(slot->event);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        slot->state = kFree;
+        ++fWrite;
+        if(!good) fStop = kTRUE;
+        free = fSourceWaiting && size - (fRead - fWrite) >= fBatch;
+      }
+      if(free) fFreeCondition.notify_one();
+    }
+  }
+  catch(std::runtime_error &e)
+  {
+    Fail(e.what());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fFreeCondition.notify_all();
+  fWorkCondition.notify_all();
+
+  reader.join();
+  for(i = 0; i < Int_t(workers.size()); ++i) workers[i].join();
+
+  if(!fError.empty()) throw std::runtime_error(fError);
+
+  return written;
+}
+
+#endif /* ExRootPipeline */
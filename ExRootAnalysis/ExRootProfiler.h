@@ -0,0 +1,60 @@
+#ifndef ExRootProfiler_h
+#define ExRootProfiler_h
+
+/** \class ExRootProfiler
+ *
+ *  Timing probes for hot paths.
+ *  EXROOT_PROFILE_SCOPE(name) measures the time spent until the end of the
+ *  enclosing block and adds it to a per-thread histogram of latencies.
+ *  The probes are compiled only with -DEXROOT_PROFILE (make PROFILE=1),
+ *  otherwise the macro expands to nothing.
+ *  ExRootProfiler::Report() prints the histograms summed over all threads.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include "ExRootAnalysis/ExRootTimer.h"
+
+#include <stdio.h>
+
+class ExRootProfiler
+{
+public:
+
+  enum {kMaxProbes = 64, kBuckets = 64};
+
+  class Probe
+  {
+  public:
+    Probe(const char *name);
+    Int_t GetIndex() const { return fIndex; }
+  private:
+    Int_t fIndex;
+  };
+
+  class Scope
+  {
+  public:
+    Scope(const Probe &probe) : fIndex(probe.GetIndex()), fStart(ExRootTimer::Cycles()) {}
+    ~Scope() { Add(fIndex, ExRootTimer::Cycles() - fStart); }
+  private:
+    Int_t fIndex;
+    ULong64_t fStart;
+  };
+
+  static void Add(Int_t index, ULong64_t cycles);
+
+  static void Report(FILE *file = stdout);
+};
+
+#ifdef EXROOT_PROFILE
+#define EXROOT_PROFILE_SCOPE(name) \
+  static const ExRootProfiler::Probe exRootProfilerProbe(name); \
+  ExRootProfiler::Scope exRootProfilerScope(exRootProfilerProbe)
+#else
+#define EXROOT_PROFILE_SCOPE(name)
+#endif
+
+#endif /* ExRootProfiler */
+
@@ -3,16 +3,47 @@
 
 #include "Rtypes.h"
 
+#include "ExRootAnalysis/ExRootTimer.h"
+
 class ExRootProgressBar
 {
 public:
 
+  enum EStage {kParse, kKinematics, kFill, kCompress, kStages};
+
   ExRootProgressBar(Long64_t entries, Int_t width = 64);
   ~ExRootProgressBar();
 
   void Update(Long64_t entry, Long64_t eventCounter = 0, Bool_t last = kFALSE);
   void Finish();
 
+  // per-stage timers, StopStage adds the time since the last StartStage
+
+  void StartStage() { fStageStart = ExRootTimer::Cycles(); }
+  void StopStage(Int_t stage)
+  {
+    fStageCycles[stage] += ExRootTimer::Cycles() - fStageStart;
+    ++fStageCalls[stage];
+  }
+
+  // time measured elsewhere, e.g. on another thread
+  void AddStage(Int_t stage, ULong64_t cycles, Long64_t calls)
+  {
+    fStageCycles[stage] += cycles;
+    fStageCalls[stage] += calls;
+  }
+
+  void SetBytesRead(Long64_t bytes) { fBytesRead = bytes; }
+  void SetBytesWritten(Long64_t bytes) { fBytesWritten = bytes; }
+
+  Long64_t GetBytesRead() const { return fBytesRead; }
+  Long64_t GetBytesWritten() const { return fBytesWritten; }
+
+  // machine-readable summary in JSON format, "-" writes to stdout,
+  // rates are computed over the time since construction
+
+  void WriteSummary(const char *fileName);
+
 private:
 
   Long64_t fEntries, fEventCounter;
@@ -22,6 +53,16 @@ private:
   Int_t fHashes;
 
   char *fBar; //!
+
+  Long64_t fEvents;
+  Long64_t fBytesRead, fBytesWritten;
+
+  ULong64_t fStartCycles, fStartTime;
+  ULong64_t fNextCycles;
+
+  ULong64_t fStageStart;
+  ULong64_t fStageCycles[kStages];
+  Long64_t fStageCalls[kStages];
 };
 
 #endif /* ExRootProgressBar */
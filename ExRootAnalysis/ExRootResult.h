@@ -7,6 +7,7 @@
 
 #include <set>
 #include <map>
+#include <vector>
 
 class TH1;
 class TH2;
@@ -17,6 +18,7 @@ class TProfile;
 class TPaveText;
 class TObjArray;
 class TFolder;
+class TDirectory;
 
 class ExRootResult
 {
@@ -28,7 +30,29 @@ public:
 
   void Reset();
   void Write(const char *fileName = "results.root");
-  void Print(const char *format = "eps");
+
+  // Checkpoint updates the file in place, writing only plots whose contents
+  // or attachments changed since the previous checkpoint; the slots are
+  // summed into temporary copies and not reset, but they are read without
+  // any lock, so the threads filling them must be paused (e.g. at a barrier)
+  // until Checkpoint returns and may resume filling the same slots afterwards;
+  // Merge adds up plots with matching names and adopts the others together
+  // with their attachments and settings
+
+  void Checkpoint(const char *fileName = "results.root");
+
+  Bool_t Merge(const char *fileName);
+  void Merge(ExRootResult *result);
+
+  // Print writes one file per plot, rendering on up to 'workers' forked
+  // processes; the plots are rendered sequentially unless the process has
+  // no other thread (slot filling, ROOT implicit multithreading) and ROOT
+  // runs in batch mode (no X11 connection), a forked child could block on
+  // a lock held by another thread; PrintBook writes all plots into one
+  // multipage pdf/ps file
+
+  void Print(const char *format = "eps", Int_t workers = 1);
+  void PrintBook(const char *fileName = "results.pdf");
 
   TH1 *AddHist1D(const char *name, const char *title,
                  const char *xlabel, const char *ylabel,
@@ -65,6 +89,21 @@ public:
 
   void SetFolder(TFolder *folder) { fFolder = folder; }
 
+  // Threaded filling: every histogram booked after SetSlots(n) gets n - 1
+  // private clones, slot 0 being the booked histogram itself.
+  // Each thread fills only GetSlot(plot, slot) for its own slot,
+  // clones are merged back into the booked histograms by MergeSlots,
+  // which is called automatically by Write and Print.
+  // No thread may fill a slot during MergeSlots, Write, Print or Checkpoint.
+
+  void SetSlots(Int_t slots);
+  Int_t GetSlots() const { return fSlots; }
+
+  template<typename T>
+  T *GetSlot(T *plot, Int_t slot) { return static_cast<T *>(GetSlotPlot(plot, slot)); }
+
+  void MergeSlots();
+
 private:
 
   struct PlotSettings
@@ -75,6 +114,19 @@ private:
 
   void CreateCanvas();
 
+  void DrawPlot(TCanvas *canvas, TObject *plot, TObjArray *attachment);
+
+  void WritePlot(TDirectory *dir, TObject *plot, TObjArray *attachment, TObject *contents = 0);
+
+  Bool_t ReadFile(const char *fileName);
+
+  void Adopt(ExRootResult *result, TObject *plot, TObject *target);
+  void MergeStack(ExRootResult *result, THStack *stack, THStack *other);
+
+  void AddSlotPlots(TH1 *plot);
+  TH1 *GetSlotPlot(TH1 *plot, Int_t slot);
+  TH1 *SumSlots(TH1 *plot);
+
   TCanvas *fCanvas; //!
 
   std::set<TObject*> fPool; //!
@@ -83,9 +135,18 @@ private:
 
   std::map<TObject*, ExRootResult::PlotSettings> fSettings; //!
 
+  std::map<TObject*, ULong64_t> fCheckpoint; //!
+
   TFolder *fFolder; //!
 
+  Int_t fSlots; //!
+
+  std::map<TH1*, std::vector<TH1*> > fSlotPlots; //!
+
 };
 
+// common style of the histograms booked by ExRootResult
+void HistStyle(TH1 *hist, Bool_t stats = kTRUE);
+
 #endif /* ExRootResult_h */
 
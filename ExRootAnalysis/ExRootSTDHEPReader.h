@@ -18,6 +18,11 @@
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
+#include <vector>
+
+#include "ExRootAnalysis/ExRootStructs.h"
+#include "ExRootAnalysis/ExRootEventView.h"
+
 class ExRootTreeBranch;
 class ExRootFactory;
 
@@ -48,9 +53,25 @@ public:
 
   void AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber);
 
+  // the same with plain structures instead of branches (ExRootStructs.h),
+  // the particles are appended to the vector
+  bool ReadBlock(std::vector<ExRootGenParticle> &particles);
+  void AnalyzeEvent(ExRootLHEFEvent &event, long long eventNumber);
+
+  // reads up to the end of the next event, kFALSE at the end of the input,
+  // the view stays valid until the next event is read (ExRootEventView.h),
+  // not to be mixed with ReadBlock
+  bool ReadEvent(ExRootSTDHEPEventView &view);
+
+  // calls the handler for every event up to the end of the input or until
+  // it returns kFALSE, returns the number of events
+  long long ReadEvents(ExRootEventHandler<ExRootSTDHEPEventView> *handler);
+
 private:
 
-  void AnalyzeParticles(ExRootTreeBranch *branch);
+  template <typename T> bool Read(T *output);
+  template <typename T> void FillEvent(T *element, long long eventNumber);
+  template <typename T> void AnalyzeParticles(T *output);
 
   void SkipBytes(u_int size);
   void SkipArray(u_int elsize);
@@ -74,6 +95,10 @@ private:
 
   u_int fScaleSize;
   double fScale[10];
+
+  std::vector<ExRootGenParticle> fParticles;
+  ExRootLHEFEvent fEvent;
+  long long fEventCounter;
 };
 
 #endif // ExRootSTDHEPReader_h
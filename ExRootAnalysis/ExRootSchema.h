@@ -0,0 +1,183 @@
+#ifndef ExRootSchema_h
+#define ExRootSchema_h
+
+/** \class ExRootSchema
+ *
+ *  Data members of the classes stored in the root tree, one list per class.
+ *  EXROOT_SCHEMA_<class>(FIELD) expands FIELD(type, name, title) for every
+ *  data member in the order of declaration, EXROOT_SCHEMA_CLASSES(CLASS)
+ *  expands CLASS(class, name) for every class, where name is the class
+ *  name without the TRoot prefix.
+ *
+ *  ExRootClasses.h declares the data members by hand, the comments are
+ *  the titles used by rootcling and by doc/awk/classes_gen.awk, and checks
+ *  them against these lists with EXROOT_SCHEMA_CHECK. ExRootColumns.h
+ *  generates column views and fill helpers and ExRootStructs.h plain
+ *  structures without TObject from them. A new data member is added here
+ *  and in ExRootClasses.h with the same title, with a new version in ClassDef.
+ *  The classes are still listed in ExRootAnalysisLinkDef.h, #pragma link
+ *  can't be generated by the preprocessor.
+ *
+ */
+
+#include <type_traits>
+
+//---------------------------------------------------------------------------
+
+#define EXROOT_SCHEMA_TRootWeight(FIELD) \
+  FIELD(Double_t, Weight, "weight for the event")
+
+#define EXROOT_SCHEMA_TRootLHEFEvent(FIELD) \
+  FIELD(Long64_t, Number, "event number") \
+  FIELD(Int_t, Nparticles, "number of particles in the event | hepup.NUP") \
+  FIELD(Int_t, ProcessID, "subprocess code for the event | hepup.IDPRUP") \
+  FIELD(Double_t, Weight, "weight for the event | hepup.XWGTUP") \
+  FIELD(Double_t, ScalePDF, "scale in GeV used in the calculation of the PDFs in the event | hepup.SCALUP") \
+  FIELD(Double_t, CouplingQED, "value of the QED coupling used in the event | hepup.AQEDUP") \
+  FIELD(Double_t, CouplingQCD, "value of the QCD coupling used in the event | hepup.AQCDUP")
+
+#define EXROOT_SCHEMA_TRootLHEFParticle(FIELD) \
+  FIELD(Int_t, PID, "particle HEP ID number | hepup.IDUP[number]") \
+  FIELD(Int_t, Status, "particle status code | hepup.ISTUP[number]") \
+  FIELD(Int_t, Mother1, "index for the particle first mother | hepup.MOTHUP[number][0]") \
+  FIELD(Int_t, Mother2, "index for the particle last mother | hepup.MOTHUP[number][1]") \
+  FIELD(Int_t, ColorLine1, "index for the particle color-line | hepup.ICOLUP[number][0]") \
+  FIELD(Int_t, ColorLine2, "index for the particle anti-color-line | hepup.ICOLUP[number][1]") \
+  FIELD(Double_t, Px, "particle momentum vector (x component) | hepup.PUP[number][0]") \
+  FIELD(Double_t, Py, "particle momentum vector (y component) | hepup.PUP[number][1]") \
+  FIELD(Double_t, Pz, "particle momentum vector (z component) | hepup.PUP[number][2]") \
+  FIELD(Double_t, E, "particle energy | hepup.PUP[number][3]") \
+  FIELD(Double_t, M, "particle mass | hepup.PUP[number][4]") \
+  FIELD(Double_t, PT, "particle transverse momentum") \
+  FIELD(Double_t, Eta, "particle pseudorapidity") \
+  FIELD(Double_t, Phi, "particle azimuthal angle") \
+  FIELD(Double_t, Rapidity, "particle rapidity") \
+  FIELD(Double_t, LifeTime, "particle invariant lifetime (c*tau, distance from production to decay in mm) | hepup.VTIMUP[number]") \
+  FIELD(Double_t, Spin, "cosine of the angle between the particle spin vector and the decaying particle 3-momentum, specified in the lab frame. | hepup.SPINUP[number]")
+
+#define EXROOT_SCHEMA_TRootGenEvent(FIELD) \
+  FIELD(Long64_t, Number, "event number | hepevt.nevhep")
+
+#define EXROOT_SCHEMA_TRootGenParticle(FIELD) \
+  FIELD(Int_t, PID, "particle HEP ID number | hepevt.idhep[number]") \
+  FIELD(Int_t, Status, "particle status | hepevt.isthep[number]") \
+  FIELD(Int_t, M1, "particle 1st mother | hepevt.jmohep[number][0] - 1") \
+  FIELD(Int_t, M2, "particle 2nd mother | hepevt.jmohep[number][1] - 1") \
+  FIELD(Int_t, D1, "particle 1st daughter | hepevt.jdahep[number][0] - 1") \
+  FIELD(Int_t, D2, "particle 2nd daughter | hepevt.jdahep[number][1] - 1") \
+  FIELD(Double_t, E, "particle energy | hepevt.phep[number][3]") \
+  FIELD(Double_t, Px, "particle momentum vector (x component) | hepevt.phep[number][0]") \
+  FIELD(Double_t, Py, "particle momentum vector (y component) | hepevt.phep[number][1]") \
+  FIELD(Double_t, Pz, "particle momentum vector (z component) | hepevt.phep[number][2]") \
+  FIELD(Double_t, PT, "particle transverse momentum") \
+  FIELD(Double_t, Eta, "particle pseudorapidity") \
+  FIELD(Double_t, Phi, "particle azimuthal angle") \
+  FIELD(Double_t, Rapidity, "particle rapidity") \
+  FIELD(Double_t, T, "particle vertex position (t component) | hepevt.vhep[number][3]") \
+  FIELD(Double_t, X, "particle vertex position (x component) | hepevt.vhep[number][0]") \
+  FIELD(Double_t, Y, "particle vertex position (y component) | hepevt.vhep[number][1]") \
+  FIELD(Double_t, Z, "particle vertex position (z component) | hepevt.vhep[number][2]")
+
+#define EXROOT_SCHEMA_TRootGenJet(FIELD) \
+  FIELD(Double_t, E, "jet energy") \
+  FIELD(Double_t, Px, "jet momentum vector (x component)") \
+  FIELD(Double_t, Py, "jet momentum vector (y component)") \
+  FIELD(Double_t, Pz, "jet momentum vector (z component)") \
+  FIELD(Double_t, PT, "jet transverse momentum") \
+  FIELD(Double_t, Eta, "jet pseudorapidity") \
+  FIELD(Double_t, Phi, "jet azimuthal angle") \
+  FIELD(Double_t, Rapidity, "jet rapidity") \
+  FIELD(Double_t, Mass, "jet invariant mass")
+
+#define EXROOT_SCHEMA_TRootEvent(FIELD) \
+  FIELD(Long64_t, Number, "event number") \
+  FIELD(Int_t, Trigger, "trigger word")
+
+#define EXROOT_SCHEMA_TRootMissingET(FIELD) \
+  FIELD(Double_t, MET, "mising transverse energy") \
+  FIELD(Double_t, Phi, "mising energy azimuthal angle")
+
+#define EXROOT_SCHEMA_TRootPhoton(FIELD) \
+  FIELD(Double_t, PT, "photon transverse momentum") \
+  FIELD(Double_t, Eta, "photon pseudorapidity") \
+  FIELD(Double_t, Phi, "photon azimuthal angle") \
+  FIELD(Double_t, EhadOverEem, "ratio of the hadronic versus electromagnetic energy deposited in the calorimeter")
+
+#define EXROOT_SCHEMA_TRootElectron(FIELD) \
+  FIELD(Double_t, PT, "electron transverse momentum") \
+  FIELD(Double_t, Eta, "electron pseudorapidity") \
+  FIELD(Double_t, Phi, "electron azimuthal angle") \
+  FIELD(Double_t, Charge, "electron charge") \
+  FIELD(Double_t, Ntrk, "number of tracks associated with the electron") \
+  FIELD(Double_t, EhadOverEem, "ratio of the hadronic versus electromagnetic energy deposited in the calorimeter")
+
+#define EXROOT_SCHEMA_TRootMuon(FIELD) \
+  FIELD(Double_t, PT, "muon transverse momentum") \
+  FIELD(Double_t, Eta, "muon pseudorapidity") \
+  FIELD(Double_t, Phi, "muon azimuthal angle") \
+  FIELD(Double_t, Charge, "muon charge") \
+  FIELD(Double_t, Ntrk, "number of tracks associated with the muon") \
+  FIELD(Double_t, PTiso, "sum of tracks transverse momentum within a cone of radius R=0.4 centered on the muon (excluding the muon itself)") \
+  FIELD(Double_t, ETiso, "ratio of ET in a 3x3 calorimeter cells array around the muon (including the muon's cell) to the muon PT") \
+  FIELD(Int_t, JetIndex, "index of the closest jet")
+
+#define EXROOT_SCHEMA_TRootTau(FIELD) \
+  FIELD(Double_t, PT, "tau transverse momentum") \
+  FIELD(Double_t, Eta, "tau pseudorapidity") \
+  FIELD(Double_t, Phi, "tau azimuthal angle") \
+  FIELD(Double_t, Charge, "tau charge") \
+  FIELD(Double_t, Ntrk, "number of charged tracks associated with the tau") \
+  FIELD(Double_t, EhadOverEem, "ratio of the hadronic versus electromagnetic energy deposited in the calorimeter")
+
+#define EXROOT_SCHEMA_TRootJet(FIELD) \
+  FIELD(Double_t, PT, "jet transverse momentum") \
+  FIELD(Double_t, Eta, "jet pseudorapidity") \
+  FIELD(Double_t, Phi, "jet azimuthal angle") \
+  FIELD(Double_t, Mass, "jet invariant mass") \
+  FIELD(Double_t, Ntrk, "number of tracks associated with the jet") \
+  FIELD(Double_t, BTag, "1 or 2 for a jet that has been tagged as containing a heavy quark") \
+  FIELD(Double_t, EhadOverEem, "ratio of the hadronic versus electromagnetic energy deposited in the calorimeter") \
+  FIELD(Int_t, Index, "jet index in the LHC Olympics file")
+
+//---------------------------------------------------------------------------
+
+#define EXROOT_SCHEMA_CLASSES(CLASS) \
+  CLASS(TRootWeight, Weight) \
+  CLASS(TRootLHEFEvent, LHEFEvent) \
+  CLASS(TRootLHEFParticle, LHEFParticle) \
+  CLASS(TRootGenEvent, GenEvent) \
+  CLASS(TRootGenParticle, GenParticle) \
+  CLASS(TRootGenJet, GenJet) \
+  CLASS(TRootEvent, Event) \
+  CLASS(TRootMissingET, MissingET) \
+  CLASS(TRootPhoton, Photon) \
+  CLASS(TRootElectron, Electron) \
+  CLASS(TRootMuon, Muon) \
+  CLASS(TRootTau, Tau) \
+  CLASS(TRootJet, Jet)
+
+//---------------------------------------------------------------------------
+
+// data member declaration, used inside the structure definitions
+#define EXROOT_SCHEMA_MEMBER(type, name, title) type name;
+
+// compile-time check of a tree class against its list: every member
+// has to be declared with the listed type, and the listed members have
+// to fill the class after the TObject header, which catches most missing,
+// additional or reordered members
+
+#define EXROOT_SCHEMA_CHECK_MEMBER(type, name, title) \
+  static_assert(std::is_same<decltype(Class::name), type>::value, \
+    "type of " #name " differs from ExRootSchema.h");
+
+#define EXROOT_SCHEMA_CHECK(cls, name) \
+struct ExRootSchemaCheck##name \
+{ \
+  typedef cls Class; \
+  struct Members { EXROOT_SCHEMA_##cls(EXROOT_SCHEMA_MEMBER) }; \
+  EXROOT_SCHEMA_##cls(EXROOT_SCHEMA_CHECK_MEMBER) \
+  static_assert(sizeof(Class) == sizeof(TObject) + sizeof(Members), \
+    "data members of " #cls " differ from ExRootSchema.h"); \
+};
+
+#endif /* ExRootSchema */
@@ -0,0 +1,35 @@
+#ifndef ExRootSpan_h
+#define ExRootSpan_h
+
+/** \class ExRootSpan
+ *
+ *  Read-only view of a contiguous array that belongs to someone else.
+ *
+ */
+
+#include <stddef.h>
+
+template<typename T>
+class ExRootSpan
+{
+public:
+
+  ExRootSpan() : fData(0), fSize(0) {}
+  ExRootSpan(const T *data, size_t size) : fData(data), fSize(size) {}
+
+  const T *begin() const { return fData; }
+  const T *end() const { return fData + fSize; }
+
+  const T &operator[](size_t i) const { return fData[i]; }
+
+  const T *data() const { return fData; }
+  size_t size() const { return fSize; }
+  bool empty() const { return fSize == 0; }
+
+private:
+
+  const T *fData;
+  size_t fSize;
+};
+
+#endif /* ExRootSpan */
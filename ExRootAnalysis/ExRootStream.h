@@ -14,6 +14,8 @@
  *
  */
 
+#include <atomic>
+
 class ExRootStream
 {
 public:
@@ -26,12 +28,15 @@ public:
 private:
 
   char *fBuffer;
+
+  // warnings are printed once per process, streams are used
+  // from several threads at the same time
   
-  static bool fFirstLongMin;
-  static bool fFirstLongMax;
-  static bool fFirstHugePos;
-  static bool fFirstHugeNeg;
-  static bool fFirstZero;
+  static std::atomic<bool> fFirstLongMin;
+  static std::atomic<bool> fFirstLongMax;
+  static std::atomic<bool> fFirstHugePos;
+  static std::atomic<bool> fFirstHugeNeg;
+  static std::atomic<bool> fFirstZero;
 };
 
 #endif // ExRootStream_h
@@ -0,0 +1,28 @@
+#ifndef ExRootStructs_h
+#define ExRootStructs_h
+
+/** \class ExRootStructs
+ *
+ *  Plain structures with the data members of the tree classes listed in
+ *  ExRootSchema.h, ExRootGenParticle for TRootGenParticle and so on.
+ *  They have no TObject header and no virtual functions and are kept in
+ *  std::vector for in-memory processing without ROOT I/O,
+ *  ExRootCopy.h converts them to and from the tree classes.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include "ExRootAnalysis/ExRootSchema.h"
+
+//---------------------------------------------------------------------------
+
+#define EXROOT_STRUCT(cls, name) \
+struct ExRoot##name \
+{ \
+  EXROOT_SCHEMA_##cls(EXROOT_SCHEMA_MEMBER) \
+};
+
+EXROOT_SCHEMA_CLASSES(EXROOT_STRUCT)
+
+#endif /* ExRootStructs */
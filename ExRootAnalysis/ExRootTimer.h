@@ -0,0 +1,43 @@
+#ifndef ExRootTimer_h
+#define ExRootTimer_h
+
+/** \class ExRootTimer
+ *
+ *  Cheap time stamps for instrumentation of event loops.
+ *  Cycles() reads the time stamp counter where available (a few ns per
+ *  call), it has to be converted to seconds by comparing two pairs of
+ *  Cycles() and Nanoseconds() readings.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class ExRootTimer
+{
+public:
+
+  static ULong64_t Cycles()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return Nanoseconds();
+#endif
+  }
+
+  static ULong64_t Nanoseconds()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ULong64_t(ts.tv_sec)*1000000000ULL + ts.tv_nsec;
+  }
+};
+
+#endif /* ExRootTimer */
+
@@ -25,7 +25,11 @@ public:
 
   class MemoryAllocationExeption{};
   
-  ExRootTreeBranch(const char *name, TClass *cl, TTree *tree = 0);
+  // with reuse the objects are constructed once and kept between events,
+  // Clear only resets the size and NewEntry returns the old objects, that
+  // have to be overwritten completely; only for classes without references,
+  // see ExRootReuseTraits
+  ExRootTreeBranch(const char *name, TClass *cl, TTree *tree = 0, Bool_t reuse = kFALSE);
   ~ExRootTreeBranch();
 
   TObject *NewEntry();
@@ -34,6 +38,7 @@ public:
 private:
 
   Int_t fSize, fCapacity;
+  Bool_t fReuse;
   TClonesArray *fData;  
 };
 
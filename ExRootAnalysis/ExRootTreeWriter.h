@@ -16,12 +16,16 @@
 #include "TNamed.h"
  
 #include <set>
+#include <vector>
 
 class TFile;
 class TTree;
 class TClass;
+class TBranch;
 class ExRootTreeBranch;
 
+template <typename T> struct ExRootReuseTraits;
+
 class ExRootTreeWriter : public TNamed
 {
 public:
@@ -32,9 +36,37 @@ public:
   void SetTreeFile(TFile *file) { fFile = file; }
   void SetTreeName(const char *name) { fTreeName = name; }
 
-  ExRootTreeBranch *NewBranch(const char *name, TClass *cl);
+  // starts a new file name_1.root, name_2.root, ... at the first cluster
+  // boundary after the current file has reached maxBytes or maxEntries
+  // (0 for no limit), the names of all files are written one per line
+  // to fileList, ready for FillChain; existing files are not overwritten,
+  // the rotation stops and the current file grows instead
+  void SetFileRotation(Long64_t maxBytes, Long64_t maxEntries, const char *fileList = 0);
+
+  // continues with an empty tree in file, the branches are kept,
+  // the tree has to be written with Write() before, the previous file
+  // can be closed afterwards, file = 0 keeps the tree in memory
+  void ChangeFile(TFile *file);
+
+  ExRootTreeBranch *NewBranch(const char *name, TClass *cl, Bool_t reuse = kFALSE);
+
+  // branch of class T, objects are reused between events if
+  // ExRootReuseTraits<T> allows it (ExRootClasses.h)
+  template <typename T>
+  ExRootTreeBranch *NewBranch(const char *name)
+  {
+    return NewBranch(name, T::Class(), ExRootReuseTraits<T>::kReusable);
+  }
+
   ExRootTreeBranch *NewFactory(const char *name, TClass *cl);
 
+  // branch of fixed-size leaves read directly from address,
+  // see TTree::Branch for the format of leafList
+  TBranch *NewLeaf(const char *name, void *address, const char *leafList);
+
+  // object stored once with the tree (TTree::GetUserInfo), owned by the tree
+  void AddUserInfo(TObject *object);
+
   void Clear();
   void Fill();
   void Write();
@@ -43,10 +75,18 @@ private:
 
   TTree *NewTree();
 
+  void RotateFile();
+  void WriteFileList();
+
   TFile *fFile;
   TTree *fTree;
 
   TString fTreeName;
+
+  Long64_t fMaxBytes, fMaxEntries;
+  TString fFileList;
+  std::vector<TString> fFileNames;
+  TFile *fOwnFile; // current file if it was opened by the writer
   
   std::set<ExRootTreeBranch*> fBranches;
 
@@ -15,11 +15,8 @@
 
 #include "Rtypes.h"
 
-class TH1;
 class TChain;
 
-void HistStyle(TH1 *hist, Bool_t stats = kTRUE);
-
 Bool_t FillChain(TChain *chain, const char *inputFileList);
 
 #endif // ExRootUtilities_h
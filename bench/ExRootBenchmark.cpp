@@ -0,0 +1,688 @@
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <rpc/types.h>
+#include <rpc/xdr.h>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TChain.h"
+#include "TMath.h"
+#include "TRandom3.h"
+#include "TObjArray.h"
+#include "TBranch.h"
+#include "TLorentzVector.h"
+
+#include "ExRootAnalysis/ExRootClasses.h"
+#include "ExRootAnalysis/ExRootTreeReader.h"
+#include "ExRootAnalysis/ExRootSTDHEPReader.h"
+#include "ExRootAnalysis/ExRootTimer.h"
+
+using namespace std;
+
+/*
+End-to-end benchmark of the converters and of the ExRootTreeReader read path.
+Synthetic inputs are generated in the current directory for every supported
+format, each converter and the read path run as separate processes started
+with execv, so that the peak resident memory is measured separately for
+every step. The read path is the benchmark itself started in --read mode,
+it reports the number of entries found in the output tree and this number
+is compared with the number of generated events. The start-up time of
+every converter is measured on a one-event input, the fastest of
+kStartupRuns runs is reported.
+*/
+
+//------------------------------------------------------------------------------
+
+struct BenchmarkResult
+{
+  string name;
+  Long64_t events;
+  Long64_t inputBytes;
+  Long64_t outputBytes;
+  Double_t seconds;
+  Long64_t peakRSS;
+  Bool_t failed;
+};
+
+//------------------------------------------------------------------------------
+
+static const Int_t kParticleTypes = 8;
+static const Int_t kParticlePID[kParticleTypes] = {1, 2, 21, 11, 13, 22, 211, 5};
+static const Double_t kParticleMass[kParticleTypes] = {0.0, 0.0, 0.0, 0.000511, 0.10566, 0.0, 0.13957, 4.7};
+
+static const Int_t kStartupRuns = 5;
+
+//------------------------------------------------------------------------------
+
+static Int_t GenerateParticle(TRandom3 &random, TLorentzVector &momentum)
+{
+  Int_t type = Int_t(random.Integer(kParticleTypes));
+  Double_t pt = 1.0 + random.Exp(20.0);
+  Double_t eta = random.Uniform(-5.0, 5.0);
+  Double_t phi = random.Uniform(-TMath::Pi(), TMath::Pi());
+
+  momentum.SetPtEtaPhiM(pt, eta, phi, kParticleMass[type]);
+
+  return (random.Rndm() < 0.5 ? -1 : 1)*kParticlePID[type];
+}
+
+//------------------------------------------------------------------------------
+
+static Long64_t GetFileSize(const char *fileName)
+{
+  struct stat info;
+  if(stat(fileName, &info) != 0) return 0;
+  return info.st_size;
+}
+
+//------------------------------------------------------------------------------
+
+static FILE *OpenOutput(const char *fileName)
+{
+  stringstream message;
+  FILE *file = fopen(fileName, "w");
+  if(!file)
+  {
+    message << "can't create " << fileName;
+    throw runtime_error(message.str());
+  }
+  return file;
+}
+
+//------------------------------------------------------------------------------
+
+static void GenerateLHEF(const char *fileName, Long64_t events, Int_t multiplicity, Int_t weights)
+{
+  TRandom3 random(4357);
+  TLorentzVector momentum;
+  Long64_t entry;
+  Int_t i, pid;
+
+  FILE *file = OpenOutput(fileName);
+
+  fprintf(file, "<LesHouchesEvents version=\"3.0\">\n");
+  fprintf(file, "<header>\n<initrwgt>\n<weightgroup name=\"synthetic\">\n");
+  for(i = 0; i < weights; ++i)
+  {
+    fprintf(file, "<weight id=\"%d\"> variation %d </weight>\n", i + 1, i + 1);
+  }
+  fprintf(file, "</weightgroup>\n</initrwgt>\n</header>\n");
+  fprintf(file, "<init>\n 2212 2212 6.5e+03 6.5e+03 0 0 247000 247000 -4 1\n");
+  fprintf(file, " 1.0e+00 1.0e-02 1.0e+00 1\n</init>\n");
+
+  for(entry = 0; entry < events; ++entry)
+  {
+    fprintf(file, "<event>\n");
+    fprintf(file, " %d 1 %+.10e %.10e %.10e %.10e\n", multiplicity,
+      random.Uniform(0.5, 1.5), 91.188, 0.0078125, 0.118);
+
+    for(i = 0; i < multiplicity; ++i)
+    {
+      pid = GenerateParticle(random, momentum);
+      fprintf(file, " %8d %2d %4d %4d %4d %4d %+.10e %+.10e %+.10e %.10e %.10e %.4e %.4e\n",
+        pid, i < 2 ? -1 : 1, i < 2 ? 0 : 1, i < 2 ? 0 : 2, 501, 0,
+        momentum.Px(), momentum.Py(), momentum.Pz(), momentum.E(), momentum.M(), 0.0, 9.0);
+    }
+
+    if(weights > 0)
+    {
+      fprintf(file, "<rwgt>\n");
+      for(i = 0; i < weights; ++i)
+      {
+        fprintf(file, "<wgt id='%d'> %+.10e </wgt>\n", i + 1, random.Uniform(0.5, 1.5));
+      }
+      fprintf(file, "</rwgt>\n");
+    }
+
+    fprintf(file, "</event>\n");
+  }
+
+  fprintf(file, "</LesHouchesEvents>\n");
+  fclose(file);
+}
+
+//------------------------------------------------------------------------------
+
+static void WriteString(XDR *xdr, const char *string)
+{
+  char buffer[64];
+  char *pointer = buffer;
+  strncpy(buffer, string, sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+  xdr_string(xdr, &pointer, sizeof(buffer));
+}
+
+//------------------------------------------------------------------------------
+
+static void WriteInts(XDR *xdr, vector<int> &data)
+{
+  u_int size = data.size();
+  xdr_u_int(xdr, &size);
+  for(u_int i = 0; i < size; ++i) xdr_int(xdr, &data[i]);
+}
+
+//------------------------------------------------------------------------------
+
+static void WriteDoubles(XDR *xdr, vector<double> &data)
+{
+  u_int size = data.size();
+  xdr_u_int(xdr, &size);
+  for(u_int i = 0; i < size; ++i) xdr_double(xdr, &data[i]);
+}
+
+//------------------------------------------------------------------------------
+
+static void WriteSTDCM1(XDR *xdr, int blockType)
+{
+  int i, zero = 0;
+
+  xdr_int(xdr, &blockType);
+  xdr_int(xdr, &zero);
+  WriteString(xdr, "1.00");
+
+  // 5*4 + 2*8 = 36 bytes
+  for(i = 0; i < 9; ++i) xdr_int(xdr, &zero);
+}
+
+//------------------------------------------------------------------------------
+
+static void GenerateSTDHEP(const char *fileName, Long64_t events, Int_t multiplicity)
+{
+  TRandom3 random(4357);
+  TLorentzVector momentum;
+  Long64_t entry;
+  XDR xdr;
+  int i, blockType, zero = 0, number, size = multiplicity;
+  u_int entries = events, noBlocks = 0, scaleSize = 1;
+  double weight, alphaQED = 0.0078125, alphaQCD = 0.118, scale = 91.188;
+
+  vector<int> isthep(size), idhep(size), jmohep(2*size), jdahep(2*size);
+  vector<double> phep(5*size), vhep(4*size, 0.0);
+
+  FILE *file = OpenOutput(fileName);
+  xdrstdio_create(&xdr, file, XDR_ENCODE);
+
+  // file header, version 2.01
+
+  blockType = ExRootSTDHEPReader::FILEHEADER;
+  xdr_int(&xdr, &blockType);
+  xdr_int(&xdr, &zero);
+  WriteString(&xdr, "2.01");
+  WriteString(&xdr, "synthetic");
+  WriteString(&xdr, "ExRootBenchmark");
+  WriteString(&xdr, "");
+  WriteString(&xdr, "");
+  xdr_u_int(&xdr, &entries);
+  xdr_u_int(&xdr, &entries);
+  xdr_int(&xdr, &zero);
+  xdr_int(&xdr, &zero);
+  xdr_u_int(&xdr, &noBlocks);
+  xdr_u_int(&xdr, &noBlocks);
+
+  WriteSTDCM1(&xdr, ExRootSTDHEPReader::MCFIO_STDHEPBEG);
+
+  for(entry = 0; entry < events; ++entry)
+  {
+    for(i = 0; i < size; ++i)
+    {
+      idhep[i] = GenerateParticle(random, momentum);
+      isthep[i] = i < 2 ? 3 : 1;
+      jmohep[2*i] = jmohep[2*i + 1] = i < 2 ? 0 : 1;
+      jdahep[2*i] = jdahep[2*i + 1] = 0;
+      phep[5*i + 0] = momentum.Px();
+      phep[5*i + 1] = momentum.Py();
+      phep[5*i + 2] = momentum.Pz();
+      phep[5*i + 3] = momentum.E();
+      phep[5*i + 4] = momentum.M();
+    }
+
+    blockType = ExRootSTDHEPReader::MCFIO_STDHEP4;
+    number = entry + 1;
+    weight = random.Uniform(0.5, 1.5);
+
+    xdr_int(&xdr, &blockType);
+    xdr_int(&xdr, &zero);
+    WriteString(&xdr, "2.00");
+    xdr_int(&xdr, &number);
+    xdr_int(&xdr, &size);
+    WriteInts(&xdr, isthep);
+    WriteInts(&xdr, idhep);
+    WriteInts(&xdr, jmohep);
+    WriteInts(&xdr, jdahep);
+    WriteDoubles(&xdr, phep);
+    WriteDoubles(&xdr, vhep);
+
+    xdr_double(&xdr, &weight);
+    xdr_double(&xdr, &alphaQED);
+    xdr_double(&xdr, &alphaQCD);
+    xdr_u_int(&xdr, &scaleSize);
+    xdr_double(&xdr, &scale);
+    xdr_u_int(&xdr, &noBlocks);
+    xdr_u_int(&xdr, &noBlocks);
+    xdr_int(&xdr, &zero);
+  }
+
+  WriteSTDCM1(&xdr, ExRootSTDHEPReader::MCFIO_STDHEPEND);
+
+  xdr_destroy(&xdr);
+  fclose(file);
+}
+
+//------------------------------------------------------------------------------
+
+static void GenerateLHCO(const char *fileName, Long64_t events, Int_t multiplicity)
+{
+  TRandom3 random(4357);
+  Long64_t entry;
+  Int_t i, type;
+
+  FILE *file = OpenOutput(fileName);
+
+  fprintf(file, "  #  typ      eta      phi       pt    jmas  ntrk  btag   had/em  dum1  dum2\n");
+
+  for(entry = 0; entry < events; ++entry)
+  {
+    fprintf(file, "  0 %13lld %6d\n", entry + 1, 0);
+
+    for(i = 0; i < multiplicity; ++i)
+    {
+      type = Int_t(random.Integer(5));
+      fprintf(file, "%3d %4d %8.3f %8.3f %8.2f %7.2f %5.1f %5.1f %8.2f %5.1f %5.1f\n",
+        i + 1, type, random.Uniform(-2.5, 2.5), random.Uniform(0.0, TMath::TwoPi()),
+        1.0 + random.Exp(30.0), type == 4 ? random.Exp(10.0) : 0.0,
+        type == 4 ? Double_t(random.Integer(20)) : (random.Rndm() < 0.5 ? -1.0 : 1.0),
+        type == 4 ? Double_t(random.Integer(3)) : 0.0, random.Exp(1.0), 0.0, 0.0);
+    }
+
+    fprintf(file, "%3d %4d %8.3f %8.3f %8.2f %7.2f %5.1f %5.1f %8.2f %5.1f %5.1f\n",
+      multiplicity + 1, 6, 0.0, random.Uniform(0.0, TMath::TwoPi()),
+      random.Exp(30.0), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  }
+
+  fclose(file);
+}
+
+//------------------------------------------------------------------------------
+
+static void GenerateHEPEVT(const char *fileName, const char *listName, Long64_t events, Int_t multiplicity)
+{
+  TRandom3 random(4357);
+  TLorentzVector momentum;
+  Long64_t entry;
+  Int_t i, status, nhep = multiplicity;
+  stringstream message;
+
+  vector<Int_t> idhep(nhep), jsmhep(nhep), jsdhep(nhep);
+  vector<Float_t> phep(5*nhep), vhep(4*nhep, 0.0);
+
+  TFile *file = TFile::Open(fileName, "RECREATE");
+  if(!file)
+  {
+    message << "can't create " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  TTree *tree = new TTree("h101", "HEPEVT");
+  tree->Branch("Nhep", &nhep, "Nhep/I");
+  tree->Branch("Idhep", &idhep[0], "Idhep[Nhep]/I");
+  tree->Branch("Jsmhep", &jsmhep[0], "Jsmhep[Nhep]/I");
+  tree->Branch("Jsdhep", &jsdhep[0], "Jsdhep[Nhep]/I");
+  tree->Branch("Phep", &phep[0], "Phep[Nhep][5]/F");
+  tree->Branch("Vhep", &vhep[0], "Vhep[Nhep][4]/F");
+
+  for(entry = 0; entry < events; ++entry)
+  {
+    for(i = 0; i < nhep; ++i)
+    {
+      idhep[i] = GenerateParticle(random, momentum);
+      status = i < 2 ? 3 : 1;
+      // status and mother/daughter indices packed as in HEPEVT ntuples
+      jsmhep[i] = status*16000000 + (i < 2 ? 0 : 1)*4000 + (i < 2 ? 0 : 2);
+      jsdhep[i] = 0;
+      phep[5*i + 0] = momentum.Px();
+      phep[5*i + 1] = momentum.Py();
+      phep[5*i + 2] = momentum.Pz();
+      phep[5*i + 3] = momentum.E();
+      phep[5*i + 4] = momentum.M();
+    }
+    tree->Fill();
+  }
+
+  file->Write();
+  delete file;
+
+  FILE *list = OpenOutput(listName);
+  fprintf(list, "%s\n", fileName);
+  fclose(list);
+}
+
+//------------------------------------------------------------------------------
+
+static Long64_t ReadTree(const char *fileName, const char *treeName)
+{
+  TChain chain(treeName);
+  chain.Add(fileName);
+
+  ExRootTreeReader *treeReader = new ExRootTreeReader(&chain);
+
+  TObjArray *branches = chain.GetListOfBranches();
+  Int_t i;
+  for(i = 0; branches && i < branches->GetEntriesFast(); ++i)
+  {
+    treeReader->UseBranch(branches->At(i)->GetName());
+  }
+
+  Long64_t entry, allEntries = treeReader->GetEntries();
+  for(entry = 0; entry < allEntries; ++entry)
+  {
+    treeReader->ReadEntry(entry);
+  }
+
+  delete treeReader;
+
+  return allEntries;
+}
+
+//------------------------------------------------------------------------------
+
+static void Measure(BenchmarkResult &result, const vector<string> &command,
+                    const char *inputFile, const char *outputFile, Long64_t *entries = 0)
+{
+  ULong64_t start;
+  pid_t pid;
+  int status = 0, null, report[2] = {-1, -1};
+  struct rusage usage;
+  vector<char *> arguments;
+  string output;
+  char buffer[256];
+  ssize_t size;
+  size_t i;
+
+  result.inputBytes = GetFileSize(inputFile);
+  result.outputBytes = 0;
+  result.seconds = 0.0;
+  result.peakRSS = 0;
+  result.failed = kTRUE;
+
+  if(outputFile) unlink(outputFile);
+
+  for(i = 0; i < command.size(); ++i)
+  {
+    arguments.push_back(const_cast<char *>(command[i].c_str()));
+  }
+  arguments.push_back(0);
+
+  // the read path reports the number of entries on its standard output
+  if(entries && pipe(report) != 0)
+  {
+    throw runtime_error("can't create pipe");
+  }
+
+  fflush(stdout);
+  fflush(stderr);
+
+  start = ExRootTimer::Nanoseconds();
+
+  pid = fork();
+  if(pid < 0)
+  {
+    throw runtime_error("can't fork");
+  }
+  else if(pid == 0)
+  {
+    // converters print progress bars, keep only the report on the terminal
+    if(entries)
+    {
+      close(report[0]);
+      dup2(report[1], STDOUT_FILENO);
+    }
+    else
+    {
+      null = open("/dev/null", O_WRONLY);
+      if(null >= 0) dup2(null, STDOUT_FILENO);
+    }
+
+    execv(arguments[0], &arguments[0]);
+    _exit(127);
+  }
+
+  if(entries)
+  {
+    close(report[1]);
+    while((size = read(report[0], buffer, sizeof(buffer))) > 0)
+    {
+      output.append(buffer, size);
+    }
+    close(report[0]);
+  }
+
+  if(wait4(pid, &status, 0, &usage) < 0)
+  {
+    throw runtime_error("can't wait for child process");
+  }
+
+  result.seconds = 1.0e-9*(ExRootTimer::Nanoseconds() - start);
+  // kilobytes on Linux, bytes on Mac OS X
+#ifdef __APPLE__
+  result.peakRSS = usage.ru_maxrss;
+#else
+  result.peakRSS = Long64_t(usage.ru_maxrss)*1024;
+#endif
+  result.outputBytes = outputFile ? GetFileSize(outputFile) : 0;
+  result.failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+
+  if(entries)
+  {
+    // the count is the last line written by the read path
+    i = output.rfind('\n', output.size() > 1 ? output.size() - 2 : 0);
+    i = (i == string::npos) ? 0 : i + 1;
+    if(result.failed || sscanf(output.c_str() + i, "%lld", entries) != 1)
+    {
+      *entries = -1;
+      result.failed = kTRUE;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static void PrintReport(const vector<BenchmarkResult> &results)
+{
+  vector<BenchmarkResult>::const_iterator itResults;
+  Double_t seconds;
+
+  printf("** %-36s %10s %10s %12s %10s %14s %12s\n",
+    "step", "events", "time [s]", "events/s", "MB/s", "peak RSS [MB]", "output [MB]");
+
+  for(itResults = results.begin(); itResults != results.end(); ++itResults)
+  {
+    if(itResults->failed)
+    {
+      printf("** %-36s %10s\n", itResults->name.c_str(), "FAILED");
+      continue;
+    }
+
+    seconds = itResults->seconds > 0.0 ? itResults->seconds : 1.0e-9;
+
+    printf("** %-36s %10lld %10.3f %12.1f %10.2f %14.1f %12.2f\n",
+      itResults->name.c_str(), itResults->events, itResults->seconds,
+      itResults->events/seconds, itResults->inputBytes/seconds/1048576.0,
+      itResults->peakRSS/1048576.0, itResults->outputBytes/1048576.0);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "ExRootBenchmark";
+  Long64_t events = 10000, entries;
+  Int_t multiplicity = 20, weights = 10;
+  string binDir, fileName;
+  size_t i, slash;
+  Int_t run;
+
+  // read path started by Measure, see ReadTree
+  if(argc == 4 && strcmp(argv[1], "--read") == 0)
+  {
+    try
+    {
+      entries = ReadTree(argv[2], argv[3]);
+    }
+    catch(runtime_error &e)
+    {
+      cerr << "** ERROR: " << e.what() << endl;
+      return 1;
+    }
+    printf("%lld\n", entries);
+    return 0;
+  }
+
+  if(argc > 4 || (argc > 1 && argv[1][0] == '-'))
+  {
+    cout << " Usage: " << appName << " [events]" << " [multiplicity]" << " [weights]" << endl;
+    cout << " events - number of events in every synthetic input (default 10000)," << endl;
+    cout << " multiplicity - number of particles or objects per event (default 20)," << endl;
+    cout << " weights - number of LHEF reweighting weights per event (default 10)." << endl;
+    return 1;
+  }
+
+  if(argc > 1) events = atoll(argv[1]);
+  if(argc > 2) multiplicity = atoi(argv[2]);
+  if(argc > 3) weights = atoi(argv[3]);
+
+  if(events < 1) events = 1;
+  if(multiplicity < 2) multiplicity = 2;
+  if(weights < 0) weights = 0;
+
+  // converters are expected next to the benchmark executable
+  fileName = argv[0];
+  slash = fileName.rfind('/');
+  binDir = (slash == string::npos) ? "." : fileName.substr(0, slash);
+
+  try
+  {
+    struct Step
+    {
+      const char *name, *converter, *input, *output, *tree;
+    } steps[] = {
+      {"LHEF", "ExRootLHEFConverter", "bench_lhef.lhe", "bench_lhef.root", "LHEF"},
+      {"STDHEP", "ExRootSTDHEPConverter", "bench_stdhep.hep", "bench_stdhep.root", "STDHEP"},
+      {"LHCO", "ExRootLHCOlympicsConverter", "bench_lhco.lhco", "bench_lhco.root", "LHCO"},
+      {"HEPEVT", "ExRootHEPEVTConverter", "bench_hepevt.list", "bench_hepevt.root", "Analysis"}
+    };
+    const size_t nSteps = sizeof(steps)/sizeof(steps[0]);
+
+    vector<BenchmarkResult> results;
+    BenchmarkResult result;
+    vector<string> command;
+
+    cout << "** Generating " << events << " events with " << multiplicity << " particles" << endl;
+
+    GenerateLHEF(steps[0].input, events, multiplicity, weights);
+    GenerateSTDHEP(steps[1].input, events, multiplicity);
+    GenerateLHCO(steps[2].input, events, multiplicity);
+    GenerateHEPEVT("bench_hepevt_h101.root", steps[3].input, events, multiplicity);
+
+    for(i = 0; i < nSteps; ++i)
+    {
+      cout << "** Converting " << steps[i].input << endl;
+
+      command.clear();
+      command.push_back(binDir + "/" + steps[i].converter);
+      command.push_back(steps[i].input);
+      command.push_back(steps[i].output);
+
+      result.name = string(steps[i].converter);
+      result.events = events;
+      Measure(result, command, steps[i].input, steps[i].output);
+      // the input of the HEPEVT converter is the list, count the ntuple instead
+      if(i == 3) result.inputBytes = GetFileSize("bench_hepevt_h101.root");
+      results.push_back(result);
+    }
+
+    for(i = 0; i < nSteps; ++i)
+    {
+      if(results[i].failed) continue;
+
+      cout << "** Reading " << steps[i].output << endl;
+
+      command.clear();
+      command.push_back(binDir + "/" + appName);
+      command.push_back("--read");
+      command.push_back(steps[i].output);
+      command.push_back(steps[i].tree);
+
+      result.name = string("ExRootTreeReader ") + steps[i].name;
+      Measure(result, command, steps[i].output, 0, &entries);
+      result.events = entries;
+
+      // the converter has to write one entry per generated event
+      if(!result.failed && entries != events)
+      {
+        cerr << "** ERROR: " << steps[i].output << " contains " << entries;
+        cerr << " entries instead of " << events << endl;
+        results[i].events = entries;
+        results[i].failed = kTRUE;
+      }
+      results.push_back(result);
+    }
+
+    // one event, the time is dominated by the start-up of the converter
+
+    const char *startupInputs[] = {"bench_startup.lhe", "bench_startup.hep", "bench_startup.lhco", "bench_startup_hepevt.list"};
+    BenchmarkResult best;
+
+    GenerateLHEF(startupInputs[0], 1, multiplicity, weights);
+    GenerateSTDHEP(startupInputs[1], 1, multiplicity);
+    GenerateLHCO(startupInputs[2], 1, multiplicity);
+    GenerateHEPEVT("bench_startup_hepevt_h101.root", startupInputs[3], 1, multiplicity);
+
+    for(i = 0; i < nSteps; ++i)
+    {
+      cout << "** Starting " << steps[i].converter << endl;
+
+      command.clear();
+      command.push_back(binDir + "/" + steps[i].converter);
+      command.push_back(startupInputs[i]);
+      command.push_back("bench_startup.root");
+
+      for(run = 0; run < kStartupRuns; ++run)
+      {
+        Measure(result, command, startupInputs[i], "bench_startup.root");
+        if(result.failed) break;
+        if(run == 0 || result.seconds < best.seconds) best = result;
+      }
+      if(result.failed) best = result;
+
+      best.name = string("start-up ") + steps[i].converter;
+      best.events = 1;
+      results.push_back(best);
+    }
+
+    PrintReport(results);
+
+    cout << "** Exiting..." << endl;
+
+    return 0;
+  }
+  catch(runtime_error &e)
+  {
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
+
@@ -0,0 +1,354 @@
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <new>
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "TROOT.h"
+#include "TClass.h"
+#include "TString.h"
+#include "TObjArray.h"
+#include "TRandom3.h"
+
+#include "ExRootAnalysis/ExRootClasses.h"
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+#include "ExRootAnalysis/ExRootFactory.h"
+#include "ExRootAnalysis/ExRootFilter.h"
+#include "ExRootAnalysis/ExRootClassifier.h"
+#include "ExRootAnalysis/ExRootTimer.h"
+
+using namespace std;
+
+/*
+Microbenchmarks of the per-event hot paths of the library.
+Every benchmark processes a number of events per repetition, the reported
+time is the median (and the minimum) over the repetitions in ns per
+operation, where an operation is one object created, classified or sorted.
+Allocations are counted by replacing the global operator new.
+*/
+
+//------------------------------------------------------------------------------
+
+static Long64_t gAllocations = 0;
+
+void *operator new(size_t size)
+{
+  void *pointer = malloc(size ? size : 1);
+  if(!pointer) throw bad_alloc();
+  ++gAllocations;
+  return pointer;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+  free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+  free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+  free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+  free(pointer);
+}
+
+//------------------------------------------------------------------------------
+
+class MicroBenchmark
+{
+public:
+
+  MicroBenchmark(const string &name, Long64_t operations) :
+    fName(name), fOperations(operations) {}
+  virtual ~MicroBenchmark() {}
+
+  virtual void Event() = 0;
+
+  const string &GetName() const { return fName; }
+  Long64_t GetOperations() const { return fOperations; }
+
+private:
+
+  string fName;
+  Long64_t fOperations; // operations per event
+};
+
+//------------------------------------------------------------------------------
+
+class BranchBenchmark: public MicroBenchmark
+{
+public:
+
+  BranchBenchmark(TClass *cl, Int_t multiplicity, Bool_t reuse = kFALSE) :
+    MicroBenchmark(Form("ExRootTreeBranch::NewEntry/Clear %s%s x%d", cl->GetName(), reuse ? " reuse" : "", multiplicity), multiplicity),
+    fBranch("Branch", cl, 0, reuse), fMultiplicity(multiplicity) {}
+
+  void Event()
+  {
+    Int_t i;
+    for(i = 0; i < fMultiplicity; ++i) fBranch.NewEntry();
+    fBranch.Clear();
+  }
+
+private:
+
+  ExRootTreeBranch fBranch;
+  Int_t fMultiplicity;
+};
+
+//------------------------------------------------------------------------------
+
+template<typename T>
+class FactoryBenchmark: public MicroBenchmark
+{
+public:
+
+  FactoryBenchmark(Int_t multiplicity) :
+    MicroBenchmark(Form("ExRootFactory::New<%s> x%d", T::Class()->GetName(), multiplicity), multiplicity),
+    fMultiplicity(multiplicity) {}
+
+  void Event()
+  {
+    Int_t i;
+    for(i = 0; i < fMultiplicity; ++i) fFactory.New<T>();
+    fFactory.Clear();
+  }
+
+private:
+
+  ExRootFactory fFactory;
+  Int_t fMultiplicity;
+};
+
+//------------------------------------------------------------------------------
+
+class ParticleClassifier: public ExRootClassifier
+{
+public:
+
+  ParticleClassifier(Double_t threshold) : fThreshold(threshold) {}
+
+  Int_t GetCategory(TObject *object)
+  {
+    TRootGenParticle *particle = static_cast<TRootGenParticle *>(object);
+    if(particle->PT < fThreshold) return -1;
+    return TMath::Abs(particle->PID) % 4;
+  }
+
+private:
+
+  Double_t fThreshold;
+};
+
+//------------------------------------------------------------------------------
+
+static void FillParticles(TObjArray &array, vector<TRootGenParticle> &particles, Int_t multiplicity)
+{
+  TRandom3 random(4357);
+  Int_t i;
+
+  particles.resize(multiplicity);
+  for(i = 0; i < multiplicity; ++i)
+  {
+    particles[i].PID = Int_t(random.Integer(30)) - 15;
+    particles[i].PT = random.Exp(20.0);
+    array.Add(&particles[i]);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+class FilterBenchmark: public MicroBenchmark
+{
+public:
+
+  FilterBenchmark(Int_t classifiers, Int_t multiplicity) :
+    MicroBenchmark(Form("ExRootFilter::GetSubArray %d classifiers x%d", classifiers, multiplicity), classifiers*multiplicity),
+    fArray(multiplicity), fFilter(0)
+  {
+    Int_t i;
+    FillParticles(fArray, fParticles, multiplicity);
+    for(i = 0; i < classifiers; ++i) fClassifiers.push_back(new ParticleClassifier(5.0*i));
+    fFilter = new ExRootFilter(&fArray);
+  }
+
+  ~FilterBenchmark()
+  {
+    size_t i;
+    delete fFilter;
+    for(i = 0; i < fClassifiers.size(); ++i) delete fClassifiers[i];
+  }
+
+  void Event()
+  {
+    size_t i;
+    fFilter->Reset();
+    for(i = 0; i < fClassifiers.size(); ++i) fFilter->GetSubArray(fClassifiers[i], 0);
+  }
+
+private:
+
+  TObjArray fArray;
+  vector<TRootGenParticle> fParticles;
+  vector<ParticleClassifier *> fClassifiers;
+  ExRootFilter *fFilter;
+};
+
+//------------------------------------------------------------------------------
+
+class SortBenchmark: public MicroBenchmark
+{
+public:
+
+  SortBenchmark(Int_t multiplicity) :
+    MicroBenchmark(Form("TSortableObject sort by PT x%d", multiplicity), multiplicity),
+    fArray(multiplicity), fEvent(0)
+  {
+    TRandom3 random(4357);
+    Int_t i;
+    FillParticles(fArray, fParticles, multiplicity);
+    fValues.resize(2*multiplicity);
+    for(i = 0; i < 2*multiplicity; ++i) fValues[i] = random.Exp(20.0);
+  }
+
+  void Event()
+  {
+    size_t i, size = fParticles.size();
+    // shuffle the order by assigning a different window of values
+    for(i = 0; i < size; ++i) fParticles[i].PT = fValues[(i + fEvent) % fValues.size()];
+    fArray.Sort();
+    ++fEvent;
+  }
+
+private:
+
+  TObjArray fArray;
+  vector<TRootGenParticle> fParticles;
+  vector<Double_t> fValues;
+  size_t fEvent;
+};
+
+//------------------------------------------------------------------------------
+
+static void Run(MicroBenchmark *benchmark, Long64_t events, Int_t repetitions)
+{
+  vector<Double_t> times;
+  Long64_t event, allocations;
+  ULong64_t start;
+  Int_t repetition;
+
+  // warm up, lets the containers reach their final capacity
+  for(event = 0; event < events/10 + 1; ++event) benchmark->Event();
+
+  allocations = gAllocations;
+
+  for(repetition = 0; repetition < repetitions; ++repetition)
+  {
+    start = ExRootTimer::Nanoseconds();
+    for(event = 0; event < events; ++event) benchmark->Event();
+    times.push_back(Double_t(ExRootTimer::Nanoseconds() - start)/(events*benchmark->GetOperations()));
+  }
+
+  allocations = gAllocations - allocations;
+
+  sort(times.begin(), times.end());
+
+  printf("** %-56s %10.2f %10.2f %14.3f\n", benchmark->GetName().c_str(),
+    times[times.size()/2], times.front(), Double_t(allocations)/(events*repetitions));
+  fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "ExRootMicroBenchmark";
+  Long64_t events = 10000;
+  Int_t repetitions = 5;
+  size_t i;
+
+  if(argc > 3 || (argc > 1 && argv[1][0] == '-'))
+  {
+    cout << " Usage: " << appName << " [events]" << " [repetitions]" << endl;
+    cout << " events - number of events per repetition (default 10000)," << endl;
+    cout << " repetitions - number of timed repetitions (default 5)." << endl;
+    return 1;
+  }
+
+  if(argc > 1) events = atoll(argv[1]);
+  if(argc > 2) repetitions = atoi(argv[2]);
+
+  if(events < 1) events = 1;
+  if(repetitions < 1) repetitions = 1;
+
+  gROOT->SetBatch();
+
+  TRootGenParticle::fgCompare = TComparePT<TRootGenParticle>::Instance();
+
+  try
+  {
+    const Int_t multiplicities[] = {1, 10, 100, 1000};
+    const size_t nMultiplicities = sizeof(multiplicities)/sizeof(multiplicities[0]);
+    vector<MicroBenchmark *> benchmarks;
+    Int_t classifiers;
+
+    for(i = 0; i < nMultiplicities; ++i)
+    {
+      benchmarks.push_back(new BranchBenchmark(TRootGenParticle::Class(), multiplicities[i]));
+    }
+    for(i = 0; i < nMultiplicities; ++i)
+    {
+      benchmarks.push_back(new BranchBenchmark(TRootGenParticle::Class(), multiplicities[i], kTRUE));
+    }
+    benchmarks.push_back(new BranchBenchmark(TRootWeight::Class(), 100));
+    benchmarks.push_back(new BranchBenchmark(TRootWeight::Class(), 100, kTRUE));
+
+    benchmarks.push_back(new FactoryBenchmark<TRootGenParticle>(100));
+    benchmarks.push_back(new FactoryBenchmark<TRootLHEFParticle>(100));
+    benchmarks.push_back(new FactoryBenchmark<TRootWeight>(100));
+    benchmarks.push_back(new FactoryBenchmark<TObjArray>(100));
+
+    for(classifiers = 1; classifiers <= 5; ++classifiers)
+    {
+      benchmarks.push_back(new FilterBenchmark(classifiers, 100));
+    }
+
+    for(i = 0; i < nMultiplicities; ++i)
+    {
+      benchmarks.push_back(new SortBenchmark(multiplicities[i]));
+    }
+
+    printf("** %lld events x %d repetitions\n", events, repetitions);
+    printf("** %-56s %10s %10s %14s\n", "benchmark", "ns/op", "min ns/op", "allocs/event");
+
+    for(i = 0; i < benchmarks.size(); ++i)
+    {
+      Run(benchmarks[i], events, repetitions);
+      delete benchmarks[i];
+    }
+
+    return 0;
+  }
+  catch(runtime_error &e)
+  {
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
+
@@ -103,7 +103,14 @@ proc sourceDeps {srcPrefix args} {
   puts [join $srcObjFiles $suffix]
 }
 
-proc executableDeps {args} {
+proc usesPlotting {fileName} {
+  set fid [open $fileName]
+  set result [regexp -line -- {^\s*#include\s*"ExRootAnalysis/ExRootResult\.h"} [read $fid]]
+  close $fid
+  return $result
+}
+
+proc executableDeps {exePrefix args} {
 
   global prefix suffix objSuf exeSuf
 
@@ -121,17 +128,26 @@ proc executableDeps {args} {
 
     puts "$exeName$exeSuf:$suffix$exeObjName$objSuf"
 
+    # only the executables using ExRootResult link the graphics libraries
+    if [usesPlotting $fileName] {
+      lappend plottingExeFiles $exeName$exeSuf
+    }
+
     dependencies $fileName "$exeObjName$objSuf:$suffix$fileName"
   }
 
   if [info exists exeFiles] {
-    puts -nonewline "EXECUTABLE += $suffix"
+    puts -nonewline "$exePrefix += $suffix"
     puts [join $exeFiles $suffix]
   }
   if [info exists exeObjFiles] {
-    puts -nonewline "EXECUTABLE_OBJ += $suffix"
+    puts -nonewline "${exePrefix}_OBJ += $suffix"
     puts [join $exeObjFiles $suffix]
   }
+  if [info exists plottingExeFiles] {
+    puts -nonewline "PLOTTING_EXECUTABLE += $suffix"
+    puts [join $plottingExeFiles $suffix]
+  }
 }
 
 proc headerDeps {} {
@@ -159,34 +175,66 @@ SrcSuf = cc
 PcmSuf = _rdict.pcm
 
 CXXFLAGS += $(ROOTCFLAGS) -Wno-write-strings -D_FILE_OFFSET_BITS=64 -DDROP_CGAL -I.
-LIBS = $(ROOTLIBS)
+
+# the core library and the converters are linked without the graphics
+# libraries of ROOT, they are only needed by the plotting library
+ROOTGRAPHICSLIBS = -lGpad -lGraf -lGraf3d -lPostscript -lHist -lRint -lTreePlayer \
+  -lROOTDataFrame -lROOTVecOps -lMultiProc
+LIBS = $(filter-out $(ROOTGRAPHICSLIBS),$(ROOTLIBS))
+PLOTTING_LIBS = $(ROOTLIBS)
+
+# make PROFILE=1 enables timing probes (see ExRootAnalysis/ExRootProfiler.h)
+ifeq ($(PROFILE),1)
+CXXFLAGS += -DEXROOT_PROFILE
+endif
+
+# gzip input of ExRootInputStream, make ZSTD=1 adds zstd input
+LIBS += -lz
+ifeq ($(ZSTD),1)
+CXXFLAGS += -DHAVE_ZSTD
+LIBS += -lzstd
+endif
 
 ###
 
 SHARED = libExRootAnalysis.$(DllSuf)
 SHAREDLIB = libExRootAnalysis.lib
 
+PLOTTING_SHARED = libExRootPlotting.$(DllSuf)
+PLOTTING_SHAREDLIB = libExRootPlotting.lib
+
 all:
 }
 
-executableDeps {test/*.cpp}
+executableDeps {EXECUTABLE} {test/*.cpp}
+
+executableDeps {BENCHMARK} {bench/*.cpp}
 
 dictDeps {DICT} {src/*LinkDef.h}
 
+dictDeps {PLOTTING_DICT} {plotting/*LinkDef.h}
+
 sourceDeps {SHARED} {src/*.cc}
 
+sourceDeps {PLOTTING} {plotting/*.cc}
+
 headerDeps
 
 puts {
 ###
 
 ifeq ($(ROOT_MAJOR),6)
-all: $(SHARED) $(DICT_PCM) $(EXECUTABLE)
+all: $(SHARED) $(PLOTTING_SHARED) $(DICT_PCM) $(PLOTTING_DICT_PCM) $(EXECUTABLE)
 else
-all: $(SHARED) $(EXECUTABLE)
+all: $(SHARED) $(PLOTTING_SHARED) $(EXECUTABLE)
 endif
 
 $(SHARED): $(DICT_OBJ) $(SHARED_OBJ)
+
+$(PLOTTING_SHARED): $(PLOTTING_DICT_OBJ) $(PLOTTING_OBJ)
+$(PLOTTING_SHARED): LIBS = $(PLOTTING_LIBS)
+
+$(SHARED) $(PLOTTING_SHARED):
 	@mkdir -p $(@D)
 	@echo ">> Building $@"
 ifeq ($(PLATFORM),macosx)
@@ -194,7 +242,7 @@ ifeq ($(PLATFORM),macosx)
 else
 ifeq ($(PLATFORM),win32)
 	@bindexplib $* $^ > $*.def
-	@lib -nologo -MACHINE:IX86 $^ -def:$*.def $(OutPutOpt)$(SHAREDLIB)
+	@lib -nologo -MACHINE:IX86 $^ -def:$*.def $(OutPutOpt)$(@:.$(DllSuf)=.lib)
 	@$(LD) $(SOFLAGS) $(LDFLAGS) $^ $*.exp $(LIBS) $(OutPutOpt)$@
 	@$(MT_DLL)
 else
@@ -202,12 +250,15 @@ else
 endif
 endif
 
+bench: all $(BENCHMARK)
+
 clean:
-	@rm -f $(DICT_OBJ) $(SHARED_OBJ) core
+	@rm -f $(DICT_OBJ) $(SHARED_OBJ) $(PLOTTING_DICT_OBJ) $(PLOTTING_OBJ) core
 	@rm -rf tmp
 
 distclean: clean
-	@rm -f $(SHARED) $(SHAREDLIB) $(DICT_PCM) $(EXECUTABLE)
+	@rm -f $(SHARED) $(SHAREDLIB) $(DICT_PCM) $(EXECUTABLE) $(BENCHMARK)
+	@rm -f $(PLOTTING_SHARED) $(PLOTTING_SHAREDLIB) $(PLOTTING_DICT_PCM)
 
 ###
 
@@ -221,26 +272,29 @@ distclean: clean
 	@cat $< $@.base > $@
 	@rm $@.base
 
-$(DICT_PCM): %Dict$(PcmSuf):
+$(DICT_PCM) $(PLOTTING_DICT_PCM): %Dict$(PcmSuf):
 	@echo ">> Copying $@"
 	@cp $< $@
 
-$(SHARED_OBJ): tmp/%.$(ObjSuf): %.$(SrcSuf)
+$(SHARED_OBJ) $(PLOTTING_OBJ): tmp/%.$(ObjSuf): %.$(SrcSuf)
 	@mkdir -p $(@D)
 	@echo ">> Compiling $<"
 	@$(CXX) $(CXXFLAGS) -c $< $(OutPutOpt)$@
 
-$(DICT_OBJ): %.$(ObjSuf): %.$(SrcSuf)
+$(DICT_OBJ) $(PLOTTING_DICT_OBJ): %.$(ObjSuf): %.$(SrcSuf)
 	@mkdir -p $(@D)
 	@echo ">> Compiling $<"
 	@$(CXX) $(CXXFLAGS) -c $< $(OutPutOpt)$@
 
-$(EXECUTABLE_OBJ): tmp/%.$(ObjSuf): %.cpp
+$(EXECUTABLE_OBJ) $(BENCHMARK_OBJ): tmp/%.$(ObjSuf): %.cpp
 	@mkdir -p $(@D)
 	@echo ">> Compiling $<"
 	@$(CXX) $(CXXFLAGS) -c $< $(OutPutOpt)$@
 
-$(EXECUTABLE): %$(ExeSuf): $(DICT_OBJ) $(SHARED_OBJ)
+$(PLOTTING_EXECUTABLE): $(PLOTTING_DICT_OBJ) $(PLOTTING_OBJ)
+$(PLOTTING_EXECUTABLE): LIBS += $(PLOTTING_LIBS)
+
+$(EXECUTABLE) $(BENCHMARK): %$(ExeSuf): $(DICT_OBJ) $(SHARED_OBJ)
 	@echo ">> Building $@"
 	@$(LD) $(LDFLAGS) $^ $(LIBS) $(OutPutOpt)$@
 
@@ -1,9 +1,23 @@
 #include <iostream>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #include "TApplication.h"
 #include "TLorentzVector.h"
 
 #include "TFile.h"
+#include "TBranch.h"
 
 #include "ExRootAnalysis/ExRootClasses.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
@@ -150,6 +164,56 @@ extern pgsrecF77 pgsrec_;
 //   --> all algorithms include rates for gluon, uds, c and b jets
 //
 
+// cluster list of pgsclu_ without the map of cluster indices,
+// the map is not written and would add the whole tower grid to every copy
+
+struct PGSClusterList
+{
+  int numclu;
+  double pclu[nclumx][5];
+  int etaclu[nclumx];
+  int phiclu[nclumx];
+  double emclu[nclumx];
+  double ehclu[nclumx];
+  double efclu[nclumx];
+  double widclu[nclumx];
+  int mulclu[nclumx];
+};
+
+// one event as seen by the analyse_* functions, the lists point either
+// to the common blocks or to a copy of them owned by a PGSBuffer,
+// the clusters are always copied
+
+struct PGSEvent
+{
+  PGSEvent() { ecal.reserve(1024); hcal.reserve(1024); }
+
+  const hepevtF77 *hepevt;
+  const pgstrkF77 *pgstrk;
+  const pgsrecF77 *pgsrec;
+
+  PGSClusterList pgsclu;
+
+  Double_t met, phiMET;
+
+  // energies of the hit calorimeter towers, ordered by eta and then phi
+  Int_t towers;
+  vector<Double_t> ecal, hcal;
+};
+
+// preallocated copy of one event for the writer thread,
+// only the filled part of every list is copied,
+// the calorimeter grid is reduced to the hit towers in PGSEvent
+
+struct PGSBuffer
+{
+  hepevtF77 hepevt;
+  pgstrkF77 pgstrk;
+  pgsrecF77 pgsrec;
+
+  PGSEvent event;
+};
+
 static TFile *outputFile;
 static ExRootTreeWriter *treeWriter;
 
@@ -165,17 +229,57 @@ static ExRootTreeBranch *branchTau;
 static ExRootTreeBranch *branchJet;
 static ExRootTreeBranch *branchHeavy;
 
-static void analyse_particle(Int_t number, ExRootTreeBranch *branch);
-static void analyse_track(Int_t number, ExRootTreeBranch *branch);
-static void analyse_tower(Int_t eta, Int_t phi, ExRootTreeBranch *branch);
-static void analyse_met(ExRootTreeBranch *branch);
-static void analyse_cluster(Int_t number, ExRootTreeBranch *branch);
-static void analyse_photon(Int_t number, ExRootTreeBranch *branch);
-static void analyse_electron(Int_t number, ExRootTreeBranch *branch);
-static void analyse_muon(Int_t number, ExRootTreeBranch *branch);
-static void analyse_tau(Int_t number, ExRootTreeBranch *branch);
-static void analyse_jet(Int_t number, ExRootTreeBranch *branch);
-static void analyse_heavy(Int_t number, ExRootTreeBranch *branch);
+// with PGS2ROOT_FLAT set the lists are written as fixed-size leaf arrays
+// read straight from the (copied) common blocks, e.g. Track_P[Track_size][3],
+// indices keep the Fortran convention and start at 1,
+// the branches are plain leaf lists that are read with TTree::SetBranchAddress
+
+static bool flatOutput = false;
+static vector<TBranch *> flatBranches;
+
+// occupancy of the calorimeter grid, one bit per tower in storage order
+
+static const int ntowers = nphimax*netamax;
+static const int noccupancy = (ntowers + 63)/64;
+
+static ULong64_t occupancy[noccupancy];
+
+// hit towers of the current event as eta*nphimax + phi
+static vector<Int_t> hitTowers;
+
+// events are written by a separate thread when PGS2ROOT_QUEUE
+// is set to the number of event buffers, after pgs2root_ini__
+// only the writer thread uses the ROOT objects
+
+static PGSEvent currentEvent;
+
+static vector<PGSBuffer *> buffers;
+static deque<PGSBuffer *> freeBuffers, filledBuffers;
+static mutex queueMutex;
+static condition_variable freeCondition, filledCondition;
+static thread writerThread;
+static bool queueClosed = false;
+
+static void find_towers();
+static void collect_towers(PGSEvent &event);
+static void copy_clusters(PGSEvent &event);
+static void copy_event(PGSBuffer *buffer);
+static void fill_event(const PGSEvent &event);
+static void fill_flat(const PGSEvent &event);
+static void flat_leaf(Int_t &index, const char *name, const void *address, const char *leafList);
+static void write_events();
+
+static void analyse_particle(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_track(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_tower(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_met(const PGSEvent &event, ExRootTreeBranch *branch);
+static void analyse_cluster(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_photon(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_electron(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_muon(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_tau(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_jet(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
+static void analyse_heavy(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch);
 
 extern "C"
 {
@@ -217,97 +321,438 @@ extern "C"
     outputFile = TFile::Open(outputFileName, "RECREATE");
     treeWriter = new ExRootTreeWriter(outputFile, treeName);
 
-    // generated particles from HEPEVT
-    branchGenParticle = treeWriter->NewBranch("GenParticle", TRootGenParticle::Class());
-    // reconstructed tracks
-    branchTrack = treeWriter->NewBranch("Track", TRootTrack::Class());
-    // reconstructed calorimeter towers
-    branchCalTower = treeWriter->NewBranch("CalTower", TRootCalTower::Class());
-    // missing transverse energy
-    branchMissingET = treeWriter->NewBranch("MissingET", TRootMissingET::Class());
-    // reconstructed calorimeter clusters for jets and tau leptons
-    branchCalCluster = treeWriter->NewBranch("CalCluster", TRootCalCluster::Class());
-    // reconstructed photons
-    branchPhoton = treeWriter->NewBranch("Photon", TRootPhoton::Class());
-    // reconstructed electrons
-    branchElectron = treeWriter->NewBranch("Electron", TRootElectron::Class());
-    // reconstructed muons
-    branchMuon = treeWriter->NewBranch("Muon", TRootMuon::Class());
-    // reconstructed tau leptons
-    branchTau = treeWriter->NewBranch("Tau", TRootTau::Class());
-    // reconstructed jets
-    branchJet = treeWriter->NewBranch("Jet", TRootJet::Class());
-    // reconstructed heavy particles
-    branchHeavy = treeWriter->NewBranch("Heavy", TRootHeavy::Class());
+    flatOutput = getenv("PGS2ROOT_FLAT") != 0;
+    flatBranches.clear();
+
+    // in flat mode the branches are created with the first event
+
+    if(!flatOutput)
+    {
+      // generated particles from HEPEVT
+      branchGenParticle = treeWriter->NewBranch("GenParticle", TRootGenParticle::Class());
+      // reconstructed tracks
+      branchTrack = treeWriter->NewBranch("Track", TRootTrack::Class());
+      // reconstructed calorimeter towers
+      branchCalTower = treeWriter->NewBranch("CalTower", TRootCalTower::Class());
+      // missing transverse energy
+      branchMissingET = treeWriter->NewBranch("MissingET", TRootMissingET::Class());
+      // reconstructed calorimeter clusters for jets and tau leptons
+      branchCalCluster = treeWriter->NewBranch("CalCluster", TRootCalCluster::Class());
+      // reconstructed photons
+      branchPhoton = treeWriter->NewBranch("Photon", TRootPhoton::Class());
+      // reconstructed electrons
+      branchElectron = treeWriter->NewBranch("Electron", TRootElectron::Class());
+      // reconstructed muons
+      branchMuon = treeWriter->NewBranch("Muon", TRootMuon::Class());
+      // reconstructed tau leptons
+      branchTau = treeWriter->NewBranch("Tau", TRootTau::Class());
+      // reconstructed jets
+      branchJet = treeWriter->NewBranch("Jet", TRootJet::Class());
+      // reconstructed heavy particles
+      branchHeavy = treeWriter->NewBranch("Heavy", TRootHeavy::Class());
+    }
+
+    const char *queue = getenv("PGS2ROOT_QUEUE");
+    int i, size = queue ? atoi(queue) : 0;
+
+    if(size > 0)
+    {
+      for(i = 0; i < size; ++i)
+      {
+        buffers.push_back(new PGSBuffer);
+        freeBuffers.push_back(buffers.back());
+      }
+      queueClosed = false;
+      writerThread = thread(write_events);
+    }
   }
 
 //---------------------------------------------------------------------------
 
   void pgs2root_evt__()
   {
-    Int_t particle, track, eta, phi, cluster, object;
-  
-    treeWriter->Clear();
-  
-    for(particle = 0; particle < hepevt_.nhep; ++particle)
+    PGSBuffer *buffer;
+
+    if(buffers.empty())
     {
-      analyse_particle(particle, branchGenParticle);
+      currentEvent.hepevt = &hepevt_;
+      currentEvent.pgstrk = &pgstrk_;
+      currentEvent.pgsrec = &pgsrec_;
+      copy_clusters(currentEvent);
+      collect_towers(currentEvent);
+      if(flatOutput) fill_flat(currentEvent);
+      else fill_event(currentEvent);
+      return;
     }
-  
-    for(track = 0; track < pgstrk_.numtrk; ++track)
+
+    // the simulation only waits here when all buffers are in use
+
     {
-      analyse_track(track, branchTrack);
+      unique_lock<mutex> lock(queueMutex);
+      while(freeBuffers.empty()) freeCondition.wait(lock);
+      buffer = freeBuffers.front();
+      freeBuffers.pop_front();
     }
-  
-    for(eta = 0; eta < netamax; ++eta)
+
+    copy_event(buffer);
+
     {
-      for(phi = 0; phi < nphimax; ++phi)
+      lock_guard<mutex> lock(queueMutex);
+      filledBuffers.push_back(buffer);
+    }
+    filledCondition.notify_one();
+  }
+
+//---------------------------------------------------------------------------
+
+  void pgs2root_end__()
+  {
+    vector<PGSBuffer *>::iterator itBuffers;
+
+    if(!buffers.empty())
+    {
+      // the writer thread drains the queue before it stops
       {
-        if(pgscal_.ecal[phi][eta] == 0.0 &&
-           pgscal_.hcal[phi][eta] == 0.0) continue;
+        lock_guard<mutex> lock(queueMutex);
+        queueClosed = true;
+      }
+      filledCondition.notify_one();
+      writerThread.join();
 
-        analyse_tower(eta, phi, branchCalTower);
+      for(itBuffers = buffers.begin(); itBuffers != buffers.end(); ++itBuffers)
+      {
+        delete *itBuffers;
       }
+      buffers.clear();
+      freeBuffers.clear();
     }
 
-    analyse_met(branchMissingET);
+    treeWriter->Write();
     
-    for(cluster = 0; cluster < pgsclu_.numclu; ++ cluster)
+    delete treeWriter;
+    delete outputFile;
+  }
+
+} // extern "C"
+
+//---------------------------------------------------------------------------
+
+static void find_towers()
+{
+  const double *ecal = &pgscal_.ecal[0][0];
+  const double *hcal = &pgscal_.hcal[0][0];
+  Int_t word, tower, first, last;
+  ULong64_t bits;
+
+  // both arrays are read sequentially, the comparisons of several towers
+  // are packed into one mask that is shifted into the occupancy word,
+  // NaN counts as a hit tower like in the scalar comparison
+
+  for(word = 0; word < noccupancy; ++word)
+  {
+    first = word*64;
+    last = (first + 64 < ntowers) ? first + 64 : ntowers;
+    tower = first;
+    bits = 0;
+
+#if defined(__AVX__)
+    const __m256d zero = _mm256_setzero_pd();
+    for(; tower + 4 <= last; tower += 4)
     {
-      analyse_cluster(cluster, branchCalCluster);
+      __m256d hit = _mm256_or_pd(
+        _mm256_cmp_pd(_mm256_loadu_pd(ecal + tower), zero, _CMP_NEQ_UQ),
+        _mm256_cmp_pd(_mm256_loadu_pd(hcal + tower), zero, _CMP_NEQ_UQ));
+      bits |= ULong64_t(_mm256_movemask_pd(hit)) << (tower - first);
     }
-  
-    for(object = 0; object < pgsrec_.numobj; ++object)
+#elif defined(__SSE2__)
+    const __m128d zero = _mm_setzero_pd();
+    for(; tower + 2 <= last; tower += 2)
     {
-      switch(pgsrec_.typobj[object])
-      {
-        case 0: analyse_photon(object, branchPhoton); break;
-        case 1: analyse_electron(object, branchElectron); break;
-        case 2: analyse_muon(object, branchMuon); break;
-        case 3: analyse_tau(object, branchTau); break;
-        case 4: analyse_jet(object, branchJet); break;
-        case 5: analyse_heavy(object, branchHeavy); break;
-      }
+      __m128d hit = _mm_or_pd(
+        _mm_cmpneq_pd(_mm_loadu_pd(ecal + tower), zero),
+        _mm_cmpneq_pd(_mm_loadu_pd(hcal + tower), zero));
+      bits |= ULong64_t(_mm_movemask_pd(hit)) << (tower - first);
     }
-    
-    treeWriter->Fill();
+#endif
+
+    for(; tower < last; ++tower)
+    {
+      if(ecal[tower] != 0.0 || hcal[tower] != 0.0) bits |= 1ULL << (tower - first);
+    }
+
+    occupancy[word] = bits;
   }
+}
 
 //---------------------------------------------------------------------------
 
-  void pgs2root_end__()
+static void collect_towers(PGSEvent &event)
+{
+  Int_t word, tower, eta, phi;
+  ULong64_t bits;
+  vector<Int_t>::iterator itHitTowers;
+
+  event.met = pgscal_.met_cal;
+  event.phiMET = pgscal_.phi_met_cal;
+
+  event.ecal.clear();
+  event.hcal.clear();
+
+  hitTowers.clear();
+
+  // only the words of the occupancy map with hit towers are visited
+
+  find_towers();
+
+  for(word = 0; word < noccupancy; ++word)
   {
-    treeWriter->Write();
-    
-    delete treeWriter;
-    delete outputFile;
+    for(bits = occupancy[word]; bits; bits &= bits - 1)
+    {
+#if defined(__GNUC__)
+      tower = word*64 + __builtin_ctzll(bits);
+#else
+      for(tower = word*64; !(bits >> (tower - word*64) & 1); ++tower);
+#endif
+      hitTowers.push_back((tower % netamax)*nphimax + tower / netamax);
+    }
   }
 
-} // extern "C"
+  // the occupancy map follows the storage order (phi-major), the towers
+  // are written eta-major as by the loop over the whole grid
+
+  sort(hitTowers.begin(), hitTowers.end());
+
+  for(itHitTowers = hitTowers.begin(); itHitTowers != hitTowers.end(); ++itHitTowers)
+  {
+    eta = *itHitTowers / nphimax;
+    phi = *itHitTowers % nphimax;
+    event.ecal.push_back(pgscal_.ecal[phi][eta]);
+    event.hcal.push_back(pgscal_.hcal[phi][eta]);
+  }
+
+  event.towers = event.ecal.size();
+}
+
+//---------------------------------------------------------------------------
+
+static void copy_event(PGSBuffer *buffer)
+{
+  Int_t n;
+
+  // copy the first n rows of every array of the common blocks
+
+#define COPY_ROWS(block, array) \
+  memcpy(buffer->block.array, block##_.array, n*sizeof(block##_.array[0]))
+
+  n = hepevt_.nhep;
+  buffer->hepevt.nevhep = hepevt_.nevhep;
+  buffer->hepevt.nhep = n;
+  COPY_ROWS(hepevt, isthep);
+  COPY_ROWS(hepevt, idhep);
+  COPY_ROWS(hepevt, jmohep);
+  COPY_ROWS(hepevt, jdahep);
+  COPY_ROWS(hepevt, phep);
+  COPY_ROWS(hepevt, vhep);
+
+  n = pgstrk_.numtrk;
+  buffer->pgstrk.numtrk = n;
+  COPY_ROWS(pgstrk, indtrk);
+  COPY_ROWS(pgstrk, ptrk);
+  COPY_ROWS(pgstrk, qtrk);
+
+  n = pgsrec_.numobj;
+  buffer->pgsrec.numobj = n;
+  COPY_ROWS(pgsrec, indobj);
+  COPY_ROWS(pgsrec, typobj);
+  COPY_ROWS(pgsrec, pobj);
+  COPY_ROWS(pgsrec, qobj);
+  COPY_ROWS(pgsrec, vecobj);
+
+#undef COPY_ROWS
+
+  buffer->event.hepevt = &buffer->hepevt;
+  buffer->event.pgstrk = &buffer->pgstrk;
+  buffer->event.pgsrec = &buffer->pgsrec;
+
+  copy_clusters(buffer->event);
+  collect_towers(buffer->event);
+}
+
+//---------------------------------------------------------------------------
+
+static void copy_clusters(PGSEvent &event)
+{
+  PGSClusterList *list = &event.pgsclu;
+  Int_t n = pgsclu_.numclu;
+
+#define COPY_ROWS(array) \
+  memcpy(list->array, pgsclu_.array, n*sizeof(pgsclu_.array[0]))
+
+  list->numclu = n;
+  COPY_ROWS(pclu);
+  COPY_ROWS(etaclu);
+  COPY_ROWS(phiclu);
+  COPY_ROWS(emclu);
+  COPY_ROWS(ehclu);
+  COPY_ROWS(efclu);
+  COPY_ROWS(widclu);
+  COPY_ROWS(mulclu);
+
+#undef COPY_ROWS
+}
+
+//---------------------------------------------------------------------------
+
+static void fill_event(const PGSEvent &event)
+{
+  Int_t particle, track, tower, cluster, object;
+
+  // the counts and types are taken from the event as well, in queue mode
+  // the common blocks already belong to one of the next events
+
+  treeWriter->Clear();
+
+  for(particle = 0; particle < event.hepevt->nhep; ++particle)
+  {
+    analyse_particle(event, particle, branchGenParticle);
+  }
+
+  for(track = 0; track < event.pgstrk->numtrk; ++track)
+  {
+    analyse_track(event, track, branchTrack);
+  }
+
+  // towers are filled eta-major, see collect_towers
+
+  for(tower = 0; tower < Int_t(event.ecal.size()); ++tower)
+  {
+    analyse_tower(event, tower, branchCalTower);
+  }
+
+  analyse_met(event, branchMissingET);
+
+  for(cluster = 0; cluster < event.pgsclu.numclu; ++cluster)
+  {
+    analyse_cluster(event, cluster, branchCalCluster);
+  }
+
+  for(object = 0; object < event.pgsrec->numobj; ++object)
+  {
+    switch(event.pgsrec->typobj[object])
+    {
+      case 0: analyse_photon(event, object, branchPhoton); break;
+      case 1: analyse_electron(event, object, branchElectron); break;
+      case 2: analyse_muon(event, object, branchMuon); break;
+      case 3: analyse_tau(event, object, branchTau); break;
+      case 4: analyse_jet(event, object, branchJet); break;
+      case 5: analyse_heavy(event, object, branchHeavy); break;
+    }
+  }
+
+  treeWriter->Fill();
+}
+
+//---------------------------------------------------------------------------
+
+static void flat_leaf(Int_t &index, const char *name, const void *address, const char *leafList)
+{
+  // the branches are created once, afterwards only their addresses
+  // follow the event that is written
+
+  if(index == Int_t(flatBranches.size()))
+  {
+    flatBranches.push_back(treeWriter->NewLeaf(name, const_cast<void *>(address), leafList));
+  }
+  else
+  {
+    flatBranches[index]->SetAddress(const_cast<void *>(address));
+  }
+  ++index;
+}
+
+//---------------------------------------------------------------------------
+
+static void fill_flat(const PGSEvent &event)
+{
+  const hepevtF77 *hepevt = event.hepevt;
+  const pgstrkF77 *pgstrk = event.pgstrk;
+  const PGSClusterList *pgsclu = &event.pgsclu;
+  const pgsrecF77 *pgsrec = event.pgsrec;
+  Int_t index = 0;
+
+  flat_leaf(index, "GenParticle_size", &hepevt->nhep, "GenParticle_size/I");
+  flat_leaf(index, "GenParticle_Status", hepevt->isthep, "GenParticle_Status[GenParticle_size]/I");
+  flat_leaf(index, "GenParticle_PID", hepevt->idhep, "GenParticle_PID[GenParticle_size]/I");
+  flat_leaf(index, "GenParticle_M", hepevt->jmohep, "GenParticle_M[GenParticle_size][2]/I");
+  flat_leaf(index, "GenParticle_D", hepevt->jdahep, "GenParticle_D[GenParticle_size][2]/I");
+  flat_leaf(index, "GenParticle_P", hepevt->phep, "GenParticle_P[GenParticle_size][5]/D");
+  flat_leaf(index, "GenParticle_V", hepevt->vhep, "GenParticle_V[GenParticle_size][4]/D");
+
+  flat_leaf(index, "Track_size", &pgstrk->numtrk, "Track_size/I");
+  flat_leaf(index, "Track_ParticleIndex", pgstrk->indtrk, "Track_ParticleIndex[Track_size]/I");
+  flat_leaf(index, "Track_P", pgstrk->ptrk, "Track_P[Track_size][3]/D");
+  flat_leaf(index, "Track_Charge", pgstrk->qtrk, "Track_Charge[Track_size]/D");
+
+  flat_leaf(index, "CalTower_size", &event.towers, "CalTower_size/I");
+  flat_leaf(index, "CalTower_Eem", event.ecal.data(), "CalTower_Eem[CalTower_size]/D");
+  flat_leaf(index, "CalTower_Ehad", event.hcal.data(), "CalTower_Ehad[CalTower_size]/D");
+
+  flat_leaf(index, "MissingET_MET", &event.met, "MissingET_MET/D");
+  flat_leaf(index, "MissingET_Phi", &event.phiMET, "MissingET_Phi/D");
+
+  flat_leaf(index, "CalCluster_size", &pgsclu->numclu, "CalCluster_size/I");
+  flat_leaf(index, "CalCluster_P", pgsclu->pclu, "CalCluster_P[CalCluster_size][5]/D");
+  flat_leaf(index, "CalCluster_Eta", pgsclu->etaclu, "CalCluster_Eta[CalCluster_size]/I");
+  flat_leaf(index, "CalCluster_Phi", pgsclu->phiclu, "CalCluster_Phi[CalCluster_size]/I");
+  flat_leaf(index, "CalCluster_Eem", pgsclu->emclu, "CalCluster_Eem[CalCluster_size]/D");
+  flat_leaf(index, "CalCluster_Ehad", pgsclu->ehclu, "CalCluster_Ehad[CalCluster_size]/D");
+  flat_leaf(index, "CalCluster_EemOverEtot", pgsclu->efclu, "CalCluster_EemOverEtot[CalCluster_size]/D");
+  flat_leaf(index, "CalCluster_Width", pgsclu->widclu, "CalCluster_Width[CalCluster_size]/D");
+  flat_leaf(index, "CalCluster_Ntwr", pgsclu->mulclu, "CalCluster_Ntwr[CalCluster_size]/I");
+
+  // all reconstructed objects in one list, Object_Type replaces the
+  // photon/electron/muon/tau/jet/heavy branches (see the vecobj table)
+
+  flat_leaf(index, "Object_size", &pgsrec->numobj, "Object_size/I");
+  flat_leaf(index, "Object_Type", pgsrec->typobj, "Object_Type[Object_size]/I");
+  flat_leaf(index, "Object_ParticleIndex", pgsrec->indobj, "Object_ParticleIndex[Object_size]/I");
+  flat_leaf(index, "Object_P", pgsrec->pobj, "Object_P[Object_size][4]/D");
+  flat_leaf(index, "Object_Charge", pgsrec->qobj, "Object_Charge[Object_size]/D");
+  flat_leaf(index, "Object_Vec", pgsrec->vecobj, "Object_Vec[Object_size][10]/D");
+
+  treeWriter->Fill();
+}
+
+//---------------------------------------------------------------------------
+
+static void write_events()
+{
+  PGSBuffer *buffer;
+
+  while(true)
+  {
+    {
+      unique_lock<mutex> lock(queueMutex);
+      while(!queueClosed && filledBuffers.empty()) filledCondition.wait(lock);
+      if(filledBuffers.empty()) return;
+      buffer = filledBuffers.front();
+      filledBuffers.pop_front();
+    }
+
+    if(flatOutput) fill_flat(buffer->event);
+    else fill_event(buffer->event);
+
+    {
+      lock_guard<mutex> lock(queueMutex);
+      freeBuffers.push_back(buffer);
+    }
+    freeCondition.notify_one();
+  }
+}
 
 //---------------------------------------------------------------------------
 
-static void analyse_particle(Int_t number, ExRootTreeBranch *branch)
+static void analyse_particle(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootGenParticle *entry;
 
@@ -315,17 +760,17 @@ static void analyse_particle(Int_t number, ExRootTreeBranch *branch)
 
   entry = static_cast<TRootGenParticle*>(branch->NewEntry());
 
-  entry->PID = hepevt_.idhep[number];
-  entry->Status = hepevt_.isthep[number];
-  entry->M1 = hepevt_.jmohep[number][0] - 1;
-  entry->M2 = hepevt_.jmohep[number][1] - 1;
-  entry->D1 = hepevt_.jdahep[number][0] - 1;
-  entry->D2 = hepevt_.jdahep[number][1] - 1;
+  entry->PID = event.hepevt->idhep[number];
+  entry->Status = event.hepevt->isthep[number];
+  entry->M1 = event.hepevt->jmohep[number][0] - 1;
+  entry->M2 = event.hepevt->jmohep[number][1] - 1;
+  entry->D1 = event.hepevt->jdahep[number][0] - 1;
+  entry->D2 = event.hepevt->jdahep[number][1] - 1;
 
-  entry->E = hepevt_.phep[number][3];
-  entry->Px = hepevt_.phep[number][0];
-  entry->Py = hepevt_.phep[number][1];
-  entry->Pz = hepevt_.phep[number][2];
+  entry->E = event.hepevt->phep[number][3];
+  entry->Px = event.hepevt->phep[number][0];
+  entry->Py = event.hepevt->phep[number][1];
+  entry->Pz = event.hepevt->phep[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -334,15 +779,15 @@ static void analyse_particle(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
 
-  entry->T = hepevt_.vhep[number][3];
-  entry->X = hepevt_.vhep[number][0];
-  entry->Y = hepevt_.vhep[number][1];
-  entry->Z = hepevt_.vhep[number][2];
+  entry->T = event.hepevt->vhep[number][3];
+  entry->X = event.hepevt->vhep[number][0];
+  entry->Y = event.hepevt->vhep[number][1];
+  entry->Z = event.hepevt->vhep[number][2];
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_track(Int_t number, ExRootTreeBranch *branch)
+static void analyse_track(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootTrack *entry;
 
@@ -350,9 +795,9 @@ static void analyse_track(Int_t number, ExRootTreeBranch *branch)
 
   entry = static_cast<TRootTrack*>(branch->NewEntry());
 
-  entry->Px = pgstrk_.ptrk[number][0];
-  entry->Py = pgstrk_.ptrk[number][1];
-  entry->Pz = pgstrk_.ptrk[number][2];
+  entry->Px = event.pgstrk->ptrk[number][0];
+  entry->Py = event.pgstrk->ptrk[number][1];
+  entry->Pz = event.pgstrk->ptrk[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -361,62 +806,62 @@ static void analyse_track(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
 
-  entry->Charge = pgstrk_.qtrk[number];
+  entry->Charge = event.pgstrk->qtrk[number];
 
-  entry->ParticleIndex = pgstrk_.indtrk[number] - 1;  
+  entry->ParticleIndex = event.pgstrk->indtrk[number] - 1;  
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_tower(Int_t eta, Int_t phi, ExRootTreeBranch *branch)
+static void analyse_tower(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootCalTower *entry;
 
   entry = static_cast<TRootCalTower*>(branch->NewEntry());
 
-  entry->Eem = pgscal_.ecal[phi][eta];
-  entry->Ehad = pgscal_.hcal[phi][eta];
+  entry->Eem = event.ecal[number];
+  entry->Ehad = event.hcal[number];
   entry->E = entry->Eem + entry->Ehad;
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_met(ExRootTreeBranch *branch)
+static void analyse_met(const PGSEvent &event, ExRootTreeBranch *branch)
 {
   TRootMissingET *entry;
 
   entry = static_cast<TRootMissingET*>(branch->NewEntry());
 
-  entry->MET = pgscal_.met_cal;
-  entry->Phi = pgscal_.phi_met_cal;
+  entry->MET = event.met;
+  entry->Phi = event.phiMET;
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_cluster(Int_t number, ExRootTreeBranch *branch)
+static void analyse_cluster(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootCalCluster *entry;
 
   entry = static_cast<TRootCalCluster*>(branch->NewEntry());
 
-  entry->E = pgsclu_.pclu[number][3];
-  entry->Px = pgsclu_.pclu[number][0];
-  entry->Py = pgsclu_.pclu[number][1];
-  entry->Pz = pgsclu_.pclu[number][2];
+  entry->E = event.pgsclu.pclu[number][3];
+  entry->Px = event.pgsclu.pclu[number][0];
+  entry->Py = event.pgsclu.pclu[number][1];
+  entry->Pz = event.pgsclu.pclu[number][2];
 
-  entry->Eta = pgsclu_.etaclu[number];
-  entry->Phi = pgsclu_.phiclu[number];
+  entry->Eta = event.pgsclu.etaclu[number];
+  entry->Phi = event.pgsclu.phiclu[number];
 
-  entry->Eem = pgsclu_.emclu[number];
-  entry->Ehad = pgsclu_.ehclu[number];
-  entry->EemOverEtot = pgsclu_.efclu[number];
+  entry->Eem = event.pgsclu.emclu[number];
+  entry->Ehad = event.pgsclu.ehclu[number];
+  entry->EemOverEtot = event.pgsclu.efclu[number];
 
-  entry->Ntwr = pgsclu_.mulclu[number];
+  entry->Ntwr = event.pgsclu.mulclu[number];
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_photon(Int_t number, ExRootTreeBranch *branch)
+static void analyse_photon(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootPhoton *entry;
 
@@ -424,10 +869,10 @@ static void analyse_photon(Int_t number, ExRootTreeBranch *branch)
   
   entry = static_cast<TRootPhoton*>(branch->NewEntry());
 
-  entry->E = pgsrec_.pobj[number][3];
-  entry->Px = pgsrec_.pobj[number][0];
-  entry->Py = pgsrec_.pobj[number][1];
-  entry->Pz = pgsrec_.pobj[number][2];
+  entry->E = event.pgsrec->pobj[number][3];
+  entry->Px = event.pgsrec->pobj[number][0];
+  entry->Py = event.pgsrec->pobj[number][1];
+  entry->Pz = event.pgsrec->pobj[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -436,25 +881,25 @@ static void analyse_photon(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
 
-  entry->Eem = pgsrec_.vecobj[number][0];
-  entry->Ehad = pgsrec_.vecobj[number][1];
-  entry->PTtrk = pgsrec_.vecobj[number][2];
+  entry->Eem = event.pgsrec->vecobj[number][0];
+  entry->Ehad = event.pgsrec->vecobj[number][1];
+  entry->PTtrk = event.pgsrec->vecobj[number][2];
 
-  entry->Niso = pgsrec_.vecobj[number][3];
+  entry->Niso = event.pgsrec->vecobj[number][3];
 
-  entry->ET = pgsrec_.vecobj[number][5];
-  entry->ETiso = pgsrec_.vecobj[number][6];
-  entry->PTiso = pgsrec_.vecobj[number][7];
+  entry->ET = event.pgsrec->vecobj[number][5];
+  entry->ETiso = event.pgsrec->vecobj[number][6];
+  entry->PTiso = event.pgsrec->vecobj[number][7];
 
-  entry->EhadOverEem = pgsrec_.vecobj[number][8];
-  entry->EemOverPtrk = pgsrec_.vecobj[number][9];
+  entry->EhadOverEem = event.pgsrec->vecobj[number][8];
+  entry->EemOverPtrk = event.pgsrec->vecobj[number][9];
 
-  entry->ParticleIndex = pgsrec_.indobj[number] - 1;  
+  entry->ParticleIndex = event.pgsrec->indobj[number] - 1;  
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_electron(Int_t number, ExRootTreeBranch *branch)
+static void analyse_electron(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootElectron *entry;
 
@@ -462,10 +907,10 @@ static void analyse_electron(Int_t number, ExRootTreeBranch *branch)
 
   entry = static_cast<TRootElectron*>(branch->NewEntry());
 
-  entry->E = pgsrec_.pobj[number][3];
-  entry->Px = pgsrec_.pobj[number][0];
-  entry->Py = pgsrec_.pobj[number][1];
-  entry->Pz = pgsrec_.pobj[number][2];
+  entry->E = event.pgsrec->pobj[number][3];
+  entry->Px = event.pgsrec->pobj[number][0];
+  entry->Py = event.pgsrec->pobj[number][1];
+  entry->Pz = event.pgsrec->pobj[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -474,27 +919,27 @@ static void analyse_electron(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
 
-  entry->Charge = pgsrec_.qobj[number];
+  entry->Charge = event.pgsrec->qobj[number];
 
-  entry->Eem = pgsrec_.vecobj[number][0];
-  entry->Ehad = pgsrec_.vecobj[number][1];
-  entry->PTtrk = pgsrec_.vecobj[number][2];
+  entry->Eem = event.pgsrec->vecobj[number][0];
+  entry->Ehad = event.pgsrec->vecobj[number][1];
+  entry->PTtrk = event.pgsrec->vecobj[number][2];
 
-  entry->Niso = pgsrec_.vecobj[number][3];
+  entry->Niso = event.pgsrec->vecobj[number][3];
 
-  entry->ET = pgsrec_.vecobj[number][5];
-  entry->ETiso = pgsrec_.vecobj[number][6];
-  entry->PTisoMinusPTtrk = pgsrec_.vecobj[number][7];
+  entry->ET = event.pgsrec->vecobj[number][5];
+  entry->ETiso = event.pgsrec->vecobj[number][6];
+  entry->PTisoMinusPTtrk = event.pgsrec->vecobj[number][7];
 
-  entry->EhadOverEem = pgsrec_.vecobj[number][8];
-  entry->EemOverPtrk = pgsrec_.vecobj[number][9];
+  entry->EhadOverEem = event.pgsrec->vecobj[number][8];
+  entry->EemOverPtrk = event.pgsrec->vecobj[number][9];
 
-  entry->ParticleIndex = pgsrec_.indobj[number] - 1;
+  entry->ParticleIndex = event.pgsrec->indobj[number] - 1;
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_muon(Int_t number, ExRootTreeBranch *branch)
+static void analyse_muon(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootMuon *entry;
 
@@ -502,10 +947,10 @@ static void analyse_muon(Int_t number, ExRootTreeBranch *branch)
 
   entry = static_cast<TRootMuon*>(branch->NewEntry());
 
-  entry->E = pgsrec_.pobj[number][3];
-  entry->Px = pgsrec_.pobj[number][0];
-  entry->Py = pgsrec_.pobj[number][1];
-  entry->Pz = pgsrec_.pobj[number][2];
+  entry->E = event.pgsrec->pobj[number][3];
+  entry->Px = event.pgsrec->pobj[number][0];
+  entry->Py = event.pgsrec->pobj[number][1];
+  entry->Pz = event.pgsrec->pobj[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -514,24 +959,24 @@ static void analyse_muon(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
 
-  entry->Charge = pgsrec_.qobj[number];
+  entry->Charge = event.pgsrec->qobj[number];
 
-  entry->Eem = pgsrec_.vecobj[number][0];
-  entry->Ehad = pgsrec_.vecobj[number][1];
-  entry->Ptrk = pgsrec_.vecobj[number][2];
+  entry->Eem = event.pgsrec->vecobj[number][0];
+  entry->Ehad = event.pgsrec->vecobj[number][1];
+  entry->Ptrk = event.pgsrec->vecobj[number][2];
 
-  entry->Niso = pgsrec_.vecobj[number][3];
+  entry->Niso = event.pgsrec->vecobj[number][3];
 
-  entry->Etrk = pgsrec_.vecobj[number][4];
-  entry->ETiso = pgsrec_.vecobj[number][5];
-  entry->PTiso = pgsrec_.vecobj[number][6];
+  entry->Etrk = event.pgsrec->vecobj[number][4];
+  entry->ETiso = event.pgsrec->vecobj[number][5];
+  entry->PTiso = event.pgsrec->vecobj[number][6];
 
-  entry->ParticleIndex = pgsrec_.indobj[number] - 1;
+  entry->ParticleIndex = event.pgsrec->indobj[number] - 1;
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_tau(Int_t number, ExRootTreeBranch *branch)
+static void analyse_tau(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootTau *entry;
 
@@ -539,10 +984,10 @@ static void analyse_tau(Int_t number, ExRootTreeBranch *branch)
 
   entry = static_cast<TRootTau*>(branch->NewEntry());
 
-  entry->E = pgsrec_.pobj[number][3];
-  entry->Px = pgsrec_.pobj[number][0];
-  entry->Py = pgsrec_.pobj[number][1];
-  entry->Pz = pgsrec_.pobj[number][2];
+  entry->E = event.pgsrec->pobj[number][3];
+  entry->Px = event.pgsrec->pobj[number][0];
+  entry->Py = event.pgsrec->pobj[number][1];
+  entry->Pz = event.pgsrec->pobj[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -551,25 +996,25 @@ static void analyse_tau(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
 
-  entry->Charge = pgsrec_.qobj[number];
+  entry->Charge = event.pgsrec->qobj[number];
 
-  entry->Eem = pgsrec_.vecobj[number][0];
-  entry->Ehad = pgsrec_.vecobj[number][1];
-  entry->Etrk = pgsrec_.vecobj[number][2];
+  entry->Eem = event.pgsrec->vecobj[number][0];
+  entry->Ehad = event.pgsrec->vecobj[number][1];
+  entry->Etrk = event.pgsrec->vecobj[number][2];
 
-  entry->Ntrk = pgsrec_.vecobj[number][3];
+  entry->Ntrk = event.pgsrec->vecobj[number][3];
 
-  entry->Width = pgsrec_.vecobj[number][4];
-  entry->Ecut = pgsrec_.vecobj[number][5];
-  entry->PTmax = pgsrec_.vecobj[number][6];
+  entry->Width = event.pgsrec->vecobj[number][4];
+  entry->Ecut = event.pgsrec->vecobj[number][5];
+  entry->PTmax = event.pgsrec->vecobj[number][6];
 
-  entry->SeedTrackIndex = pgsrec_.vecobj[number][7] - 1;
-  entry->ClusterIndex = pgsrec_.indobj[number] - 1;
+  entry->SeedTrackIndex = event.pgsrec->vecobj[number][7] - 1;
+  entry->ClusterIndex = event.pgsrec->indobj[number] - 1;
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_jet(Int_t number, ExRootTreeBranch *branch)
+static void analyse_jet(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootJet *entry;
 
@@ -577,10 +1022,10 @@ static void analyse_jet(Int_t number, ExRootTreeBranch *branch)
 
   entry = static_cast<TRootJet*>(branch->NewEntry());
 
-  entry->E = pgsrec_.pobj[number][3];
-  entry->Px = pgsrec_.pobj[number][0];
-  entry->Py = pgsrec_.pobj[number][1];
-  entry->Pz = pgsrec_.pobj[number][2];
+  entry->E = event.pgsrec->pobj[number][3];
+  entry->Px = event.pgsrec->pobj[number][0];
+  entry->Py = event.pgsrec->pobj[number][1];
+  entry->Pz = event.pgsrec->pobj[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -589,28 +1034,28 @@ static void analyse_jet(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
 
-  entry->Charge = pgsrec_.qobj[number];
+  entry->Charge = event.pgsrec->qobj[number];
 
-  entry->Eem = pgsrec_.vecobj[number][0];
-  entry->Ehad = pgsrec_.vecobj[number][1];
-  entry->Etrk = pgsrec_.vecobj[number][2];
+  entry->Eem = event.pgsrec->vecobj[number][0];
+  entry->Ehad = event.pgsrec->vecobj[number][1];
+  entry->Etrk = event.pgsrec->vecobj[number][2];
 
-  entry->Ntrk = pgsrec_.vecobj[number][3];
+  entry->Ntrk = event.pgsrec->vecobj[number][3];
 
-  entry->Width = pgsrec_.vecobj[number][4];
+  entry->Width = event.pgsrec->vecobj[number][4];
 
-  entry->Type = pgsrec_.vecobj[number][5]; // type: 21=g, 1=d, 2=u, 3=s, 4=c, 5=b
+  entry->Type = event.pgsrec->vecobj[number][5]; // type: 21=g, 1=d, 2=u, 3=s, 4=c, 5=b
 
-  entry->CTag = pgsrec_.vecobj[number][6];
-  entry->BTagVtx = pgsrec_.vecobj[number][7];
-  entry->BTagImp = pgsrec_.vecobj[number][8];
+  entry->CTag = event.pgsrec->vecobj[number][6];
+  entry->BTagVtx = event.pgsrec->vecobj[number][7];
+  entry->BTagImp = event.pgsrec->vecobj[number][8];
 
-  entry->ClusterIndex = pgsrec_.indobj[number] - 1;  
+  entry->ClusterIndex = event.pgsrec->indobj[number] - 1;  
 }
 
 //---------------------------------------------------------------------------
 
-static void analyse_heavy(Int_t number, ExRootTreeBranch *branch)
+static void analyse_heavy(const PGSEvent &event, Int_t number, ExRootTreeBranch *branch)
 {
   TRootHeavy *entry;
 
@@ -618,10 +1063,10 @@ static void analyse_heavy(Int_t number, ExRootTreeBranch *branch)
 
   entry = static_cast<TRootHeavy*>(branch->NewEntry());
 
-  entry->E = pgsrec_.pobj[number][3];
-  entry->Px = pgsrec_.pobj[number][0];
-  entry->Py = pgsrec_.pobj[number][1];
-  entry->Pz = pgsrec_.pobj[number][2];
+  entry->E = event.pgsrec->pobj[number][3];
+  entry->Px = event.pgsrec->pobj[number][0];
+  entry->Py = event.pgsrec->pobj[number][1];
+  entry->Pz = event.pgsrec->pobj[number][2];
 
   TVector3 vector(entry->Px, entry->Py, entry->Pz);
 
@@ -630,7 +1075,7 @@ static void analyse_heavy(Int_t number, ExRootTreeBranch *branch)
   entry->Eta = vector.CosTheta()*vector.CosTheta() == 1.0 ? signEta*999.9 : vector.Eta();
   entry->Phi = vector.Phi();
  
-  entry->ParticleIndex = pgsrec_.indobj[number] - 1;
+  entry->ParticleIndex = event.pgsrec->indobj[number] - 1;
 }
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,22 @@
+/** \class ExRootPlottingLinkDef
+ *
+ *  Lists classes of the plotting library to be included in cint dictionary
+ *
+ *  \author P. Demin - UCL, Louvain-la-Neuve
+ *
+ */
+
+#include "ExRootAnalysis/ExRootResult.h"
+
+#ifdef __CINT__
+
+#pragma link off all globals;
+#pragma link off all classes;
+#pragma link off all functions;
+
+#pragma link C++ class ExRootResult+;
+
+#pragma link C++ function HistStyle;
+
+#endif
+
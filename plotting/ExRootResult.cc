@@ -0,0 +1,1239 @@
+
+/** \class ExRootResult
+ *
+ *  Class simplifying work with histograms
+ *
+ *  $Date: 2007/07/23 14:36:04 $
+ *  $Revision: 1.5 $
+ *
+ *
+ *  \author P. Demin - UCL, Louvain-la-Neuve
+ *
+ */
+
+#include "ExRootAnalysis/ExRootResult.h"
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TClass.h"
+#include "TStyle.h"
+#include "TCanvas.h"
+#include "TLegend.h"
+#include "TPaveText.h"
+#include "TPaveStats.h"
+#include "TList.h"
+#include "TH2.h"
+#include "THStack.h"
+#include "TProfile.h"
+#include "TObjArray.h"
+#include "TFolder.h"
+#include "TKey.h"
+#include "TArrayD.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef R__WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <dirent.h>
+#endif
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+using namespace std;
+
+const Font_t kExRootFont = 42;
+const Float_t kExRootFontSize = 0.04;
+const Color_t kExRootBackgroundColor = 10;
+
+//------------------------------------------------------------------------------
+
+void HistStyle(TH1 *hist, Bool_t stats)
+{
+  hist->SetLineWidth(2);
+  hist->SetLineColor(kBlack);
+  hist->SetMarkerStyle(kFullSquare);
+  hist->SetMarkerColor(kBlack);
+
+  hist->GetXaxis()->SetTitleOffset(1.5);
+  hist->GetYaxis()->SetTitleOffset(1.75);
+  hist->GetZaxis()->SetTitleOffset(1.5);
+
+  hist->GetXaxis()->SetTitleFont(kExRootFont);
+  hist->GetYaxis()->SetTitleFont(kExRootFont);
+  hist->GetZaxis()->SetTitleFont(kExRootFont);
+  hist->GetXaxis()->SetTitleSize(kExRootFontSize);
+  hist->GetYaxis()->SetTitleSize(kExRootFontSize);
+  hist->GetZaxis()->SetTitleSize(kExRootFontSize);
+  
+  hist->GetXaxis()->SetLabelFont(kExRootFont);
+  hist->GetYaxis()->SetLabelFont(kExRootFont);
+  hist->GetZaxis()->SetLabelFont(kExRootFont);
+  hist->GetXaxis()->SetLabelSize(kExRootFontSize);
+  hist->GetYaxis()->SetLabelSize(kExRootFontSize);
+  hist->GetZaxis()->SetLabelSize(kExRootFontSize);
+
+  hist->SetStats(stats);
+}
+
+//------------------------------------------------------------------------------
+
+static void DeleteTObjectPtr(TObject *x)
+{
+  delete x;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootResult::ExRootResult() : fCanvas(0), fFolder(0), fSlots(1)
+{
+
+}
+
+//------------------------------------------------------------------------------
+
+ExRootResult::~ExRootResult()
+{
+  map<TH1*, vector<TH1*> >::iterator it_slots;
+  for(it_slots = fSlotPlots.begin(); it_slots != fSlotPlots.end(); ++it_slots)
+  {
+    for_each(it_slots->second.begin(), it_slots->second.end(), DeleteTObjectPtr);
+  }
+
+  // stacks go first, they still refer to their histograms
+
+  set<TObject*>::iterator it_pool;
+  for(it_pool = fPool.begin(); it_pool != fPool.end();)
+  {
+    if((*it_pool)->IsA()->InheritsFrom(THStack::Class()))
+    {
+      delete *it_pool;
+      fPool.erase(it_pool++);
+    }
+    else
+    {
+      ++it_pool;
+    }
+  }
+
+  for_each(fPool.begin(), fPool.end(), DeleteTObjectPtr);
+
+  if(fCanvas) delete fCanvas;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::Reset()
+{
+
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::Write(const char *fileName)
+{
+  TDirectory *currentDirectory = gDirectory; 
+  MergeSlots();
+  TFile *file = new TFile(fileName, "RECREATE");
+  file->cd();
+  map<TObject*, TObjArray*>::iterator it_plots;
+  for(it_plots = fPlots.begin(); it_plots != fPlots.end(); ++it_plots)
+  {
+    WritePlot(file, it_plots->first, it_plots->second);
+  }
+  currentDirectory->cd();
+  delete file;
+}
+
+//------------------------------------------------------------------------------
+
+static void HashBytes(ULong64_t &hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  size_t i;
+
+  // FNV-1a
+  for(i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static void HashPlot(ULong64_t &hash, TObject *plot)
+{
+  TObject *object;
+  TH1 *histogram;
+  TArrayD *sumw2;
+  Double_t value;
+  Int_t bin;
+
+  HashBytes(hash, plot->GetTitle(), strlen(plot->GetTitle()));
+
+  if(plot->IsA()->InheritsFrom(TH1::Class()))
+  {
+    histogram = static_cast<TH1*>(plot);
+    value = histogram->GetEntries();
+    HashBytes(hash, &value, sizeof(value));
+    for(bin = 0; bin < histogram->GetNcells(); ++bin)
+    {
+      value = histogram->GetBinContent(bin);
+      HashBytes(hash, &value, sizeof(value));
+    }
+    if(plot->IsA()->InheritsFrom(TProfile::Class()))
+    {
+      for(bin = 0; bin < histogram->GetNcells(); ++bin)
+      {
+        value = static_cast<TProfile*>(plot)->GetBinEntries(bin);
+        HashBytes(hash, &value, sizeof(value));
+      }
+    }
+    sumw2 = histogram->GetSumw2();
+    if(sumw2 && sumw2->GetSize() > 0)
+    {
+      HashBytes(hash, sumw2->GetArray(), sumw2->GetSize()*sizeof(Double_t));
+    }
+  }
+  else if(plot->IsA()->InheritsFrom(THStack::Class()))
+  {
+    TList *hists = static_cast<THStack*>(plot)->GetHists();
+    if(hists)
+    {
+      TIter iterator(hists);
+      while((object = iterator()))
+      {
+        HashPlot(hash, object);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static ULong64_t PlotChecksum(TObject *plot, TObjArray *attachment)
+{
+  TObject *object;
+  ULong64_t hash = 14695981039346656037ULL;
+
+  // bin contents and errors of the written copy, so that SetBinContent
+  // and SetBinError count as changes, plus the attached objects
+
+  HashPlot(hash, plot);
+
+  if(attachment)
+  {
+    TIter iterator(attachment);
+    while((object = iterator()))
+    {
+      HashBytes(hash, &object, sizeof(object));
+    }
+  }
+
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+
+TH1 *ExRootResult::SumSlots(TH1 *plot)
+{
+  TH1 *sum = 0;
+  map<TH1*, vector<TH1*> >::iterator it_slots = fSlotPlots.find(plot);
+  vector<TH1*>::iterator it_clones;
+
+  // the clones are only read, the threads filling them have to be paused
+  // by the caller, TH1::Add is not safe against a concurrent Fill
+
+  if(it_slots == fSlotPlots.end()) return 0;
+
+  for(it_clones = it_slots->second.begin(); it_clones != it_slots->second.end(); ++it_clones)
+  {
+    if((*it_clones)->GetEntries() == 0.0) continue;
+    if(!sum)
+    {
+      sum = static_cast<TH1*>(plot->Clone());
+      sum->SetDirectory(0);
+    }
+    sum->Add(*it_clones);
+  }
+
+  return sum;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::Checkpoint(const char *fileName)
+{
+  TObject *plot, *contents, *object;
+  TH1 *sum;
+  THStack *stack;
+  ULong64_t checksum;
+  vector<TH1*> sums;
+  vector<TH1*>::iterator it_sums;
+  TDirectory *currentDirectory = gDirectory;
+  map<TObject*, ULong64_t>::iterator it_checkpoint;
+
+  TFile *file = TFile::Open(fileName, "UPDATE");
+  if(!file || file->IsZombie())
+  {
+    cerr << "** ERROR: cannot open '" << fileName << "' for checkpoint" << endl;
+    if(file) delete file;
+    currentDirectory->cd();
+    return;
+  }
+
+  file->cd();
+  map<TObject*, TObjArray*>::iterator it_plots;
+  for(it_plots = fPlots.begin(); it_plots != fPlots.end(); ++it_plots)
+  {
+    plot = it_plots->first;
+    contents = plot;
+    stack = 0;
+
+    // the slots are added up in temporary copies, the booked histograms
+    // and their clones stay as they are until MergeSlots
+
+    if(plot->IsA()->InheritsFrom(TH1::Class()))
+    {
+      sum = SumSlots(static_cast<TH1*>(plot));
+      if(sum)
+      {
+        sums.push_back(sum);
+        contents = sum;
+      }
+    }
+    else if(plot->IsA()->InheritsFrom(THStack::Class()) && !fSlotPlots.empty())
+    {
+      stack = new THStack(plot->GetName(), plot->GetTitle());
+      TList *hists = static_cast<THStack*>(plot)->GetHists();
+      if(hists)
+      {
+        TIter iterator(hists);
+        while((object = iterator()))
+        {
+          sum = SumSlots(static_cast<TH1*>(object));
+          if(sum) sums.push_back(sum);
+          stack->Add(sum ? sum : static_cast<TH1*>(object));
+        }
+      }
+      contents = stack;
+    }
+
+    checksum = PlotChecksum(contents, it_plots->second);
+    it_checkpoint = fCheckpoint.find(plot);
+    if(it_checkpoint == fCheckpoint.end() || it_checkpoint->second != checksum)
+    {
+      WritePlot(file, plot, it_plots->second, contents);
+      fCheckpoint[plot] = checksum;
+    }
+
+    if(stack) delete stack;
+    for(it_sums = sums.begin(); it_sums != sums.end(); ++it_sums) delete *it_sums;
+    sums.clear();
+  }
+  file->SaveSelf(kTRUE);
+  currentDirectory->cd();
+  delete file;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::WritePlot(TDirectory *dir, TObject *plot, TObjArray *attachment, TObject *contents)
+{
+  TDirectory *subdir;
+  TString name = plot->GetName();
+
+  // contents replaces plot in the file when the slots are summed up
+
+  dir->cd();
+  (contents ? contents : plot)->Write(name, TObject::kOverwrite);
+
+  // log scale settings and attachments are stored in subdirectories
+  // to be restored by Merge
+
+  map<TObject*, PlotSettings>::iterator it_settings = fSettings.find(plot);
+  if(it_settings != fSettings.end())
+  {
+    subdir = dir->GetDirectory("settings");
+    if(!subdir) subdir = dir->mkdir("settings");
+    TNamed settings(name, TString::Format("%d %d", it_settings->second.logx, it_settings->second.logy));
+    subdir->WriteTObject(&settings, name, "WriteDelete");
+  }
+
+  if(attachment)
+  {
+    subdir = dir->GetDirectory("attachments");
+    if(!subdir) subdir = dir->mkdir("attachments");
+    subdir->WriteTObject(attachment, name, "SingleKey WriteDelete");
+  }
+
+  dir->cd();
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootResult::Merge(const char *fileName)
+{
+  ExRootResult result;
+
+  if(!result.ReadFile(fileName)) return kFALSE;
+
+  Merge(&result);
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::Merge(ExRootResult *result)
+{
+  TObject *plot, *object;
+  THStack *stack;
+  map<TString, TObject*> names;
+  map<TString, TObject*>::iterator it_names;
+  map<TObject*, TObject*> merged;
+  map<TObject*, TObject*>::iterator it_merged;
+  map<TObject*, TObjArray*>::iterator it_plots;
+  vector<TObject*> plots, stacks;
+  vector<TObject*>::iterator it_vector;
+
+  result->MergeSlots();
+
+  for(it_plots = fPlots.begin(); it_plots != fPlots.end(); ++it_plots)
+  {
+    names[it_plots->first->GetName()] = it_plots->first;
+  }
+
+  for(it_plots = result->fPlots.begin(); it_plots != result->fPlots.end(); ++it_plots)
+  {
+    plot = it_plots->first;
+    if(plot->IsA()->InheritsFrom(THStack::Class())) stacks.push_back(plot);
+    else plots.push_back(plot);
+  }
+
+  // histograms are added up, stacks are resolved afterwards
+  // because they refer to the histograms
+
+  for(it_vector = plots.begin(); it_vector != plots.end(); ++it_vector)
+  {
+    plot = *it_vector;
+    it_names = names.find(plot->GetName());
+    if(it_names == names.end())
+    {
+      Adopt(result, plot, plot);
+      names[plot->GetName()] = plot;
+    }
+    else if(plot->IsA()->InheritsFrom(TH1::Class()) &&
+            it_names->second->IsA()->InheritsFrom(TH1::Class()))
+    {
+      static_cast<TH1*>(it_names->second)->Add(static_cast<TH1*>(plot));
+      merged[plot] = it_names->second;
+    }
+  }
+
+  for(it_vector = stacks.begin(); it_vector != stacks.end(); ++it_vector)
+  {
+    plot = *it_vector;
+    it_names = names.find(plot->GetName());
+    if(it_names != names.end())
+    {
+      // histograms that only live in the stack are added up by name
+      if(it_names->second->IsA()->InheritsFrom(THStack::Class()))
+      {
+        MergeStack(result, static_cast<THStack*>(it_names->second), static_cast<THStack*>(plot));
+      }
+      continue;
+    }
+
+    stack = new THStack(plot->GetName(), plot->GetTitle());
+    TList *hists = static_cast<THStack*>(plot)->GetHists();
+    if(hists)
+    {
+      TIter iterator(hists);
+      while((object = iterator()))
+      {
+        it_merged = merged.find(object);
+        stack->Add(static_cast<TH1*>(it_merged != merged.end() ? it_merged->second : object));
+      }
+    }
+
+    Adopt(result, plot, stack);
+    names[stack->GetName()] = stack;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::Adopt(ExRootResult *result, TObject *plot, TObject *target)
+{
+  // takes over plot from result under the name of target,
+  // target is either the plot itself or its replacement,
+  // a replaced plot stays with result
+
+  TObject *object;
+  TObjArray *attachment = result->fPlots[plot];
+
+  if(plot != target) fPool.insert(target);
+  else if(result->fPool.erase(plot)) fPool.insert(plot);
+
+  // histograms of a stack that are not plots on their own
+  // are only owned by the pool
+
+  if(target->IsA()->InheritsFrom(THStack::Class()))
+  {
+    TList *hists = static_cast<THStack*>(target)->GetHists();
+    if(hists)
+    {
+      TIter iterator(hists);
+      while((object = iterator()))
+      {
+        if(result->fPool.erase(object)) fPool.insert(object);
+      }
+    }
+  }
+
+  fPlots[target] = attachment;
+  result->fPlots.erase(plot);
+
+  if(attachment)
+  {
+    TIter iterator(attachment);
+    while((object = iterator()))
+    {
+      if(result->fPool.erase(object)) fPool.insert(object);
+    }
+  }
+
+  map<TObject*, PlotSettings>::iterator it_settings = result->fSettings.find(plot);
+  if(it_settings != result->fSettings.end())
+  {
+    fSettings[target] = it_settings->second;
+    result->fSettings.erase(it_settings);
+  }
+
+  if(fFolder) fFolder->Add(target);
+
+  if(fSlots > 1 && target->IsA()->InheritsFrom(TH1::Class()))
+  {
+    AddSlotPlots(static_cast<TH1*>(target));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::MergeStack(ExRootResult *result, THStack *stack, THStack *other)
+{
+  TObject *object, *histogram;
+  TList *hists = other->GetHists();
+
+  if(!hists || !stack->GetHists()) return;
+
+  TIter iterator(hists);
+  while((object = iterator()))
+  {
+    if(result->fPlots.find(object) != result->fPlots.end()) continue;
+
+    histogram = stack->GetHists()->FindObject(object->GetName());
+    if(histogram && histogram->IsA()->InheritsFrom(TH1::Class()))
+    {
+      static_cast<TH1*>(histogram)->Add(static_cast<TH1*>(object));
+    }
+    else if(!histogram && result->fPool.erase(object))
+    {
+      fPool.insert(object);
+      stack->Add(static_cast<TH1*>(object));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootResult::ReadFile(const char *fileName)
+{
+  TKey *key;
+  TObject *plot, *object;
+  TH1 *histogram;
+  THStack *stack;
+  TDirectory *subdir;
+  PlotSettings settings;
+  map<TString, TObject*> names;
+  map<TString, TObject*>::iterator it_names;
+  vector<THStack*> stacks;
+  vector<THStack*>::iterator it_stacks;
+
+  TDirectory *currentDirectory = gDirectory;
+
+  TFile *file = TFile::Open(fileName);
+  if(!file || file->IsZombie())
+  {
+    cerr << "** ERROR: cannot open '" << fileName << "' for input" << endl;
+    if(file) delete file;
+    currentDirectory->cd();
+    return kFALSE;
+  }
+
+  // ReadFile is called from several threads by ExRootResultMerger, the
+  // process-wide TH1::AddDirectory flag is left alone, every histogram
+  // that is kept is detached from the file with SetDirectory(0) instead
+
+  TIter iterator(file->GetListOfKeys());
+  while((key = static_cast<TKey*>(iterator())))
+  {
+    TClass *cl = TClass::GetClass(key->GetClassName());
+    if(!cl || cl->InheritsFrom(TDirectory::Class())) continue;
+
+    plot = key->ReadObj();
+    if(!plot) continue;
+
+    if(plot->IsA()->InheritsFrom(THStack::Class()))
+    {
+      stacks.push_back(static_cast<THStack*>(plot));
+      continue;
+    }
+
+    if(plot->IsA()->InheritsFrom(TH1::Class()))
+    {
+      static_cast<TH1*>(plot)->SetDirectory(0);
+    }
+
+    fPool.insert(plot);
+    fPlots[plot] = 0;
+    names[plot->GetName()] = plot;
+  }
+
+  // stacks read from file hold their own copies of the histograms,
+  // replace them by the top-level histograms with the same names
+
+  for(it_stacks = stacks.begin(); it_stacks != stacks.end(); ++it_stacks)
+  {
+    stack = new THStack((*it_stacks)->GetName(), (*it_stacks)->GetTitle());
+    TList *hists = (*it_stacks)->GetHists();
+    if(hists)
+    {
+      TIter iterator(hists);
+      while((object = iterator()))
+      {
+        histogram = static_cast<TH1*>(object);
+        it_names = names.find(histogram->GetName());
+        if(it_names != names.end())
+        {
+          stack->Add(static_cast<TH1*>(it_names->second));
+          delete histogram;
+        }
+        else
+        {
+          histogram->SetDirectory(0);
+          fPool.insert(histogram);
+          stack->Add(histogram);
+        }
+      }
+    }
+    delete *it_stacks;
+    fPool.insert(stack);
+    fPlots[stack] = 0;
+    names[stack->GetName()] = stack;
+  }
+
+  subdir = file->GetDirectory("settings");
+  if(subdir)
+  {
+    TIter iterator(subdir->GetListOfKeys());
+    while((key = static_cast<TKey*>(iterator())))
+    {
+      it_names = names.find(key->GetName());
+      object = key->ReadObj();
+      if(it_names != names.end() && object &&
+         sscanf(object->GetTitle(), "%d %d", &settings.logx, &settings.logy) == 2)
+      {
+        fSettings[it_names->second] = settings;
+      }
+      delete object;
+    }
+  }
+
+  subdir = file->GetDirectory("attachments");
+  if(subdir)
+  {
+    TIter iterator(subdir->GetListOfKeys());
+    while((key = static_cast<TKey*>(iterator())))
+    {
+      it_names = names.find(key->GetName());
+      if(it_names == names.end()) continue;
+      object = key->ReadObj();
+      if(!object || !object->IsA()->InheritsFrom(TObjArray::Class()))
+      {
+        delete object;
+        continue;
+      }
+      TObjArray *attachment = static_cast<TObjArray*>(object);
+      TIter attachmentIterator(attachment);
+      while((object = attachmentIterator()))
+      {
+        if(object->IsA()->InheritsFrom(TH1::Class()))
+        {
+          static_cast<TH1*>(object)->SetDirectory(0);
+        }
+        fPool.insert(object);
+      }
+      fPlots[it_names->second] = attachment;
+    }
+  }
+
+  delete file;
+  currentDirectory->cd();
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::CreateCanvas()
+{
+  TDirectory *currentDirectory = gDirectory;
+
+  // Graphics style parameters to avoid grey background on figures
+  gStyle->SetCanvasColor(kExRootBackgroundColor);
+  gStyle->SetStatColor(kExRootBackgroundColor);
+  //  gStyle->SetTitleColor(kExRootBackgroundColor);
+  gStyle->SetPadColor(kExRootBackgroundColor);
+
+  gStyle->SetPadTopMargin(0.10);
+  gStyle->SetPadRightMargin(0.05);
+  gStyle->SetPadBottomMargin(0.15);
+  gStyle->SetPadLeftMargin(0.15);
+
+  gStyle->SetStatFont(kExRootFont);
+  gStyle->SetStatFontSize(kExRootFontSize);
+
+  gStyle->SetTitleFont(kExRootFont, "");
+  gStyle->SetTitleFont(kExRootFont, "X");
+  gStyle->SetTitleFont(kExRootFont, "Y");
+  gStyle->SetTitleFont(kExRootFont, "Z");
+  gStyle->SetTitleSize(kExRootFontSize, "");
+  gStyle->SetTitleSize(kExRootFontSize, "X");
+  gStyle->SetTitleSize(kExRootFontSize, "Y");
+  gStyle->SetTitleSize(kExRootFontSize, "Z");
+
+  gStyle->SetLabelFont(kExRootFont, "X");
+  gStyle->SetLabelFont(kExRootFont, "Y");
+  gStyle->SetLabelFont(kExRootFont, "Z");
+  gStyle->SetLabelSize(kExRootFontSize, "X");
+  gStyle->SetLabelSize(kExRootFontSize, "Y");
+  gStyle->SetLabelSize(kExRootFontSize, "Z");
+
+  gStyle->SetPadTickX(1);
+  gStyle->SetPadTickY(1);
+
+  gStyle->SetTextFont(kExRootFont);
+  gStyle->SetTextSize(kExRootFontSize);
+
+  gStyle->SetOptStat(111110);
+  // gStyle->SetOptFit(101);
+  
+  fCanvas = static_cast<TCanvas*>(gROOT->FindObject("c1"));
+  if(fCanvas)
+  {
+    fCanvas->Clear();
+    fCanvas->UseCurrentStyle();
+    fCanvas->SetWindowSize(800, 650);
+  }
+  else
+  {
+    fCanvas = new TCanvas("c1", "c1", 800, 650);
+  }
+  fCanvas->SetLogy(0);
+  fCanvas->SetHighLightColor(kExRootBackgroundColor);
+
+  currentDirectory->cd();
+}
+
+//------------------------------------------------------------------------------
+
+TCanvas *ExRootResult::GetCanvas()
+{
+  if(!fCanvas) CreateCanvas();
+  return fCanvas;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::Attach(TObject *plot, TObject *object)
+{
+  if(!plot) return;
+
+  map<TObject*, TObjArray*>::iterator it_plots = fPlots.find(plot);
+  if(it_plots != fPlots.end())
+  {
+    TObjArray *attachment = it_plots->second;
+    if(!attachment)
+    {
+      attachment = new TObjArray();
+      it_plots->second = attachment;
+    }
+    attachment->Add(object);
+  }
+}
+
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::PrintPlot(TObject *plot, const char *sufix, const char *format)
+{
+  if(!plot) return;
+
+  TCanvas *canvas = GetCanvas();
+  TH1 *histogram = 0;
+
+  if(plot->IsA()->InheritsFrom(TH1::Class()))
+  {
+    histogram = static_cast<TH1*>(plot);
+  }
+
+  map<TObject*, PlotSettings>::iterator it_settings = fSettings.find(plot);
+  if(it_settings != fSettings.end())
+  {
+    canvas->SetLogx(it_settings->second.logx);
+    if(histogram == 0 || histogram->Integral() > 0.0)
+    {
+      canvas->SetLogy(it_settings->second.logy);
+    }
+    else
+    {
+      canvas->SetLogy(0);
+    }
+  }
+  
+  map<TObject*, TObjArray*>::iterator it_plots = fPlots.find(plot);
+  if(it_plots != fPlots.end())
+  {
+    TObjArray *attachment = it_plots->second;
+    if(attachment)
+    {
+      TIter iterator(attachment);
+      TObject *object;
+      while((object = iterator()))
+      {
+        object->Draw();
+      }
+    }
+  }
+
+  TString name = plot->GetName();
+  canvas->Print(name + sufix + "." + format);
+}
+
+//------------------------------------------------------------------------------
+
+#ifndef R__WIN32
+static Int_t ThreadCount()
+{
+  // number of threads of this process, 0 if unknown
+
+  Int_t count = 0;
+
+#if defined(__linux__)
+  DIR *dir = opendir("/proc/self/task");
+  struct dirent *entry;
+  if(!dir) return 0;
+  while((entry = readdir(dir)))
+  {
+    if(entry->d_name[0] != '.') ++count;
+  }
+  closedir(dir);
+#elif defined(__APPLE__)
+  thread_act_array_t threads;
+  mach_msg_type_number_t number;
+  if(task_threads(mach_task_self(), &threads, &number) != KERN_SUCCESS) return 0;
+  count = number;
+  for(mach_msg_type_number_t i = 0; i < number; ++i) mach_port_deallocate(mach_task_self(), threads[i]);
+  vm_deallocate(mach_task_self(), vm_address_t(threads), number*sizeof(thread_act_t));
+#endif
+
+  return count;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::Print(const char *format, Int_t workers)
+{
+  Int_t index, worker;
+  map<TObject*, TObjArray*>::iterator it_plots;
+
+  MergeSlots();
+
+#ifndef R__WIN32
+  // a forked child only has the calling thread, a mutex held by another
+  // thread or a shared X11 connection would block it, so the plots are
+  // only rendered in parallel by a single-threaded process in batch mode
+
+  if(workers > 1 && fPlots.size() > 1 && (ThreadCount() != 1 || !gROOT->IsBatch()))
+  {
+    workers = 1;
+  }
+
+  if(workers > 1 && fPlots.size() > 1)
+  {
+    // each worker process renders every n-th plot on its own canvas
+    vector<pid_t> pids;
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    for(worker = 0; worker < workers; ++worker)
+    {
+      pid = fork();
+      if(pid == 0)
+      {
+        TCanvas *canvas = GetCanvas();
+        for(it_plots = fPlots.begin(), index = 0; it_plots != fPlots.end(); ++it_plots, ++index)
+        {
+          if(index % workers != worker) continue;
+          DrawPlot(canvas, it_plots->first, it_plots->second);
+          canvas->Print(TString(it_plots->first->GetName()) + "." + format);
+        }
+        fflush(stdout);
+        fflush(stderr);
+        _exit(0);
+      }
+      else if(pid < 0)
+      {
+        cerr << "** ERROR: cannot start plot rendering process" << endl;
+        break;
+      }
+      pids.push_back(pid);
+    }
+
+    Bool_t ok = (worker == workers);
+    vector<pid_t>::iterator it_pids;
+    for(it_pids = pids.begin(); it_pids != pids.end(); ++it_pids)
+    {
+      if(waitpid(*it_pids, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      {
+        ok = kFALSE;
+      }
+    }
+
+    if(ok) return;
+
+    cerr << "** WARNING: parallel plot rendering failed, rendering sequentially" << endl;
+  }
+#endif
+
+  TCanvas *canvas = GetCanvas();
+
+  for(it_plots = fPlots.begin(); it_plots != fPlots.end(); ++it_plots)
+  {
+    DrawPlot(canvas, it_plots->first, it_plots->second);
+    canvas->Print(TString(it_plots->first->GetName()) + "." + format);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::PrintBook(const char *fileName)
+{
+  TString name = fileName;
+
+  if(!name.EndsWith(".pdf") && !name.EndsWith(".ps"))
+  {
+    cerr << "** ERROR: multipage output is only supported for pdf and ps files" << endl;
+    return;
+  }
+
+  MergeSlots();
+
+  TCanvas *canvas = GetCanvas();
+
+  map<TObject*, TObjArray*>::iterator it_plots;
+
+  canvas->Print(name + "[");
+  for(it_plots = fPlots.begin(); it_plots != fPlots.end(); ++it_plots)
+  {
+    DrawPlot(canvas, it_plots->first, it_plots->second);
+    canvas->Print(name, TString("Title:") + it_plots->first->GetName());
+  }
+  canvas->Print(name + "]");
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::DrawPlot(TCanvas *canvas, TObject *plot, TObjArray *attachment)
+{
+  TObject *object;
+  TH1 *histogram = 0;
+  TPaveStats *stats;
+
+  if(plot->IsA()->InheritsFrom(TH1::Class()))
+  {
+    histogram = static_cast<TH1*>(plot);
+  }
+
+  map<TObject*, PlotSettings>::iterator it_settings = fSettings.find(plot);
+  if(it_settings != fSettings.end())
+  {
+    canvas->SetLogx(it_settings->second.logx);
+    if(histogram == 0 || histogram->Integral() > 0.0)
+    {
+      canvas->SetLogy(it_settings->second.logy);
+    }
+    else
+    {
+      canvas->SetLogy(0);
+    }
+  }
+
+  if(plot->IsA()->InheritsFrom(THStack::Class()))
+  {
+    plot->Draw("nostack");
+  }
+  else
+  {
+    plot->Draw();
+  }
+
+  canvas->Update();
+
+  if(histogram)
+  {
+    stats = static_cast<TPaveStats*>(histogram->GetListOfFunctions()->FindObject("stats"));
+    if(stats)
+    {
+      stats->SetX1NDC(0.67);
+      stats->SetX2NDC(0.99);
+      stats->SetY1NDC(0.77);
+      stats->SetY2NDC(0.99);
+      stats->SetTextFont(kExRootFont);
+      stats->SetTextSize(kExRootFontSize);
+      canvas->Draw();
+    }
+  }
+  if(attachment)
+  {
+    TIter iterator(attachment);
+    while((object = iterator()))
+    {
+      object->Draw();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::SetSlots(Int_t slots)
+{
+  map<TObject*, TObjArray*>::iterator it_plots;
+
+  if(slots < 1) slots = 1;
+  fSlots = slots;
+
+  for(it_plots = fPlots.begin(); it_plots != fPlots.end(); ++it_plots)
+  {
+    if(it_plots->first->IsA()->InheritsFrom(TH1::Class()))
+    {
+      AddSlotPlots(static_cast<TH1*>(it_plots->first));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::AddSlotPlots(TH1 *plot)
+{
+  Int_t slot;
+  TH1 *clone;
+  TString name;
+  vector<TH1*> &clones = fSlotPlots[plot];
+
+  for(slot = Int_t(clones.size()) + 1; slot < fSlots; ++slot)
+  {
+    name = plot->GetName();
+    name += "_slot";
+    name += slot;
+    clone = static_cast<TH1*>(plot->Clone(name));
+    clone->SetDirectory(0);
+    clone->Reset();
+    clones.push_back(clone);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+TH1 *ExRootResult::GetSlotPlot(TH1 *plot, Int_t slot)
+{
+  // read-only lookup, safe to call concurrently as long as
+  // no histograms are booked at the same time
+
+  if(!plot || slot <= 0) return plot;
+
+  map<TH1*, vector<TH1*> >::iterator it_slots = fSlotPlots.find(plot);
+  if(it_slots == fSlotPlots.end() || slot > Int_t(it_slots->second.size())) return plot;
+
+  return it_slots->second[slot - 1];
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootResult::MergeSlots()
+{
+  TH1 *plot, *clone;
+  map<TH1*, vector<TH1*> >::iterator it_slots;
+  vector<TH1*>::iterator it_clones;
+
+  for(it_slots = fSlotPlots.begin(); it_slots != fSlotPlots.end(); ++it_slots)
+  {
+    plot = it_slots->first;
+    for(it_clones = it_slots->second.begin(); it_clones != it_slots->second.end(); ++it_clones)
+    {
+      clone = *it_clones;
+      if(clone->GetEntries() == 0.0) continue;
+      plot->Add(clone);
+      clone->Reset();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+TH1 *ExRootResult::AddHist1D(const char *name, const char *title,
+                             const char *xlabel, const char *ylabel,
+                             Int_t nxbins, Axis_t xmin, Axis_t xmax,
+                             Int_t logx, Int_t logy)
+{
+  TH1F *hist = new TH1F(name, title, nxbins, xmin, xmax);
+  PlotSettings settings;
+  settings.logx = logx;
+  settings.logy = logy;
+  
+  fPool.insert(hist);
+  hist->GetXaxis()->SetTitle(xlabel);
+  hist->GetYaxis()->SetTitle(ylabel);
+  fPlots[hist] = 0;
+  fSettings[hist] = settings;
+  HistStyle(hist, kFALSE);
+  if(fSlots > 1) AddSlotPlots(hist);
+  return hist;
+}
+
+//------------------------------------------------------------------------------
+
+TH1 *ExRootResult::AddHist1D(const char *name, const char *title,
+                             const char *xlabel, const char *ylabel,
+                             Int_t nxbins, const Float_t *bins,
+                             Int_t logx, Int_t logy)
+{
+  TH1F *hist = new TH1F(name, title, nxbins, bins);
+  PlotSettings settings;
+  settings.logx = logx;
+  settings.logy = logy;
+
+  fPool.insert(hist);
+  hist->GetXaxis()->SetTitle(xlabel);
+  hist->GetYaxis()->SetTitle(ylabel);
+  fPlots[hist] = 0;
+  fSettings[hist] = settings;
+  HistStyle(hist, kFALSE);
+  if(fSlots > 1) AddSlotPlots(hist);
+  if(fFolder) fFolder->Add(hist);
+  return hist;
+}
+
+//------------------------------------------------------------------------------
+
+TProfile *ExRootResult::AddProfile(const char *name, const char *title,
+                                   const char *xlabel, const char *ylabel,
+                                   Int_t nxbins, Axis_t xmin, Axis_t xmax,
+                                   Int_t logx, Int_t logy)
+{
+  TProfile *profile = new TProfile(name, title, nxbins, xmin, xmax);
+  PlotSettings settings;
+  settings.logx = logx;
+  settings.logy = logy;
+
+  fPool.insert(profile);
+  profile->GetXaxis()->SetTitle(xlabel);
+  profile->GetYaxis()->SetTitle(ylabel);
+  fPlots[profile] = 0;
+  fSettings[profile] = settings;
+  HistStyle(profile, kFALSE);
+  if(fSlots > 1) AddSlotPlots(profile);
+  if(fFolder) fFolder->Add(profile);
+  return profile;
+}
+
+//------------------------------------------------------------------------------
+
+TH2 *ExRootResult::AddHist2D(const char *name, const char *title,
+                             const char *xlabel, const char *ylabel,
+                             Int_t nxbins, Axis_t xmin, Axis_t xmax,
+                             Int_t nybins, Axis_t ymin, Axis_t ymax,
+                             Int_t logx, Int_t logy)
+{
+  TH2F *hist = new TH2F(name, title, nxbins, xmin, xmax, nybins, ymin, ymax);
+  PlotSettings settings;
+  settings.logx = logx;
+  settings.logy = logy;
+
+  fPool.insert(hist);
+  hist->GetXaxis()->SetTitle(xlabel);
+  hist->GetYaxis()->SetTitle(ylabel);
+  fPlots[hist] = 0;
+  fSettings[hist] = settings;
+  HistStyle(hist, kFALSE);
+  if(fSlots > 1) AddSlotPlots(hist);
+  if(fFolder) fFolder->Add(hist);
+  return hist;
+}
+
+//------------------------------------------------------------------------------
+
+THStack *ExRootResult::AddHistStack(const char *name, const char *title)
+{
+  THStack *stack = new THStack(name, title);
+//  segmentaion violation when deleting stack in ~ExRootResult()
+//  fPool.insert(stack);
+  fPlots[stack] = 0;
+  if(fFolder) fFolder->Add(stack);
+  return stack;
+}
+
+//------------------------------------------------------------------------------
+
+TPaveText *ExRootResult::AddComment(Double_t x1, Double_t y1, Double_t x2, Double_t y2)
+{
+  TPaveText *comment = new TPaveText(x1, y1, x2, y2, "brNDC");
+  fPool.insert(comment);
+  comment->SetTextSize(kExRootFontSize);
+  comment->SetTextFont(kExRootFont);
+  comment->SetTextAlign(22);
+  comment->SetFillColor(kExRootBackgroundColor);
+  comment->SetBorderSize(2);
+  return comment;
+}
+
+//------------------------------------------------------------------------------
+
+TLegend *ExRootResult::AddLegend(Double_t x1, Double_t y1, Double_t x2, Double_t y2)
+{
+  TLegend *legend = new TLegend(x1, y1, x2, y2);
+  fPool.insert(legend);
+  legend->SetTextSize(kExRootFontSize);
+  legend->SetTextFont(kExRootFont);
+  legend->SetFillColor(kExRootBackgroundColor);
+  legend->SetBorderSize(2);
+  return legend;
+}
+
+//------------------------------------------------------------------------------
+
+
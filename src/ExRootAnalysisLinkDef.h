@@ -14,7 +14,6 @@
 #include "ExRootAnalysis/ExRootTreeReader.h"
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
-#include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootUtilities.h"
 #include "ExRootAnalysis/ExRootClassifier.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -29,6 +28,7 @@
 
 #pragma link C++ class TSortableObject+;
 #pragma link C++ class TRootWeight;
+#pragma link C++ class TRootLHEFRun+;
 #pragma link C++ class TRootLHEFEvent+;
 #pragma link C++ class TRootLHEFParticle+;
 #pragma link C++ class TRootGenEvent+;
@@ -45,13 +45,11 @@
 #pragma link C++ class ExRootTreeReader+;
 #pragma link C++ class ExRootTreeBranch+;
 #pragma link C++ class ExRootTreeWriter+;
-#pragma link C++ class ExRootResult+;
 #pragma link C++ class ExRootClassifier+;
 #pragma link C++ class ExRootFilter+;
 
 #pragma link C++ class ExRootFactory+;
 
-#pragma link C++ function HistStyle;
 #pragma link C++ function FillChain;
 
 #endif
@@ -0,0 +1,203 @@
+
+/** \class ExRootColumnReader
+ *
+ *  Maps a file written by ExRootColumnWriter into memory and gives
+ *  access to its columns without copying.
+ *
+ */
+
+#include "ExRootAnalysis/ExRootColumnReader.h"
+
+#include <iostream>
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef R__WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+ExRootColumnReader::ExRootColumnReader() :
+  fData(0), fSize(0), fMapped(kFALSE), fHeader(0), fDirectory(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+ExRootColumnReader::~ExRootColumnReader()
+{
+  Close();
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootColumnReader::Close()
+{
+#ifndef R__WIN32
+  if(fMapped) munmap(const_cast<char *>(fData), fSize);
+  else free(const_cast<char *>(fData));
+#else
+  free(const_cast<char *>(fData));
+#endif
+
+  fData = 0;
+  fSize = 0;
+  fMapped = kFALSE;
+  fHeader = 0;
+  fDirectory = 0;
+}
+
+//------------------------------------------------------------------------------
+
+static Bool_t CheckSection(Long64_t position, Long64_t size, size_t fileSize)
+{
+  return position >= 0 && size >= 0 && position % ExRootColumnWriter::kAlignment == 0 &&
+    Long64_t(fileSize) >= position && Long64_t(fileSize) - position >= size;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootColumnReader::Open(const char *fileName)
+{
+  const ExRootColumnHeader *header;
+  const ExRootColumnDirectory *entry;
+  const Long64_t *offsets;
+  UInt_t i;
+  Long64_t j, entries;
+
+  Close();
+
+#ifndef R__WIN32
+  struct stat info;
+  int fd = open(fileName, O_RDONLY);
+
+  if(fd < 0 || fstat(fd, &info) != 0)
+  {
+    if(fd >= 0) close(fd);
+    cerr << "** ERROR: can't open " << fileName << endl;
+    return kFALSE;
+  }
+
+  fSize = info.st_size;
+  if(fSize > 0)
+  {
+    void *data = mmap(0, fSize, PROT_READ, MAP_SHARED, fd, 0);
+    if(data != MAP_FAILED)
+    {
+      fData = static_cast<const char *>(data);
+      fMapped = kTRUE;
+    }
+  }
+  close(fd);
+#else
+  FILE *file = fopen(fileName, "rb");
+
+  if(!file)
+  {
+    cerr << "** ERROR: can't open " << fileName << endl;
+    return kFALSE;
+  }
+
+  fseek(file, 0L, SEEK_END);
+  fSize = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+
+  char *data = static_cast<char *>(malloc(fSize > 0 ? fSize : 1));
+  if(data && fread(data, 1, fSize, file) == fSize) fData = data;
+  else free(data);
+  fclose(file);
+#endif
+
+  if(!fData)
+  {
+    fSize = 0;
+    cerr << "** ERROR: can't read " << fileName << endl;
+    return kFALSE;
+  }
+
+  // check the whole layout once, the accessors do not check it again
+
+  header = reinterpret_cast<const ExRootColumnHeader *>(fData);
+
+  if(fSize < sizeof(ExRootColumnHeader) ||
+     strncmp(header->magic, "ExRootC", sizeof(header->magic)) != 0 ||
+     header->version != ExRootColumnHeader::kVersion ||
+     header->byteOrder != ExRootColumnHeader::kByteOrder ||
+     header->entries < 0 ||
+     (fSize - sizeof(ExRootColumnHeader))/sizeof(ExRootColumnDirectory) < header->collections)
+  {
+    Close();
+    cerr << "** ERROR: " << fileName << " is not a column file written on this platform" << endl;
+    return kFALSE;
+  }
+
+  entries = header->entries;
+  entry = reinterpret_cast<const ExRootColumnDirectory *>(header + 1);
+
+  for(i = 0; i < header->collections; ++i, ++entry)
+  {
+    offsets = reinterpret_cast<const Long64_t *>(fData + entry->offsets);
+
+    if(!CheckSection(entry->offsets, (entries + 1)*Long64_t(sizeof(Long64_t)), fSize) ||
+       !CheckSection(entry->pt, entry->objects*Long64_t(sizeof(Float_t)), fSize) ||
+       !CheckSection(entry->eta, entry->objects*Long64_t(sizeof(Float_t)), fSize) ||
+       !CheckSection(entry->phi, entry->objects*Long64_t(sizeof(Float_t)), fSize) ||
+       !CheckSection(entry->btag, entry->objects*Long64_t(sizeof(Int_t)), fSize) ||
+       offsets[0] != 0 || offsets[entries] != entry->objects)
+    {
+      Close();
+      cerr << "** ERROR: " << fileName << " is corrupted" << endl;
+      return kFALSE;
+    }
+
+    for(j = 0; j < entries; ++j)
+    {
+      if(offsets[j] > offsets[j + 1])
+      {
+        Close();
+        cerr << "** ERROR: " << fileName << " is corrupted" << endl;
+        return kFALSE;
+      }
+    }
+  }
+
+  fHeader = header;
+  fDirectory = reinterpret_cast<const ExRootColumnDirectory *>(header + 1);
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Int_t ExRootColumnReader::GetCollection(const char *name) const
+{
+  UInt_t i;
+
+  if(!fHeader) return -1;
+
+  for(i = 0; i < fHeader->collections; ++i)
+  {
+    if(strncmp(fDirectory[i].name, name, ExRootColumnDirectory::kNameSize) == 0) return i;
+  }
+
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootSpan<Long64_t> ExRootColumnReader::GetOffsets(Int_t collection) const
+{
+  if(!fHeader || collection < 0 || collection >= Int_t(fHeader->collections)) return ExRootSpan<Long64_t>();
+  return ExRootSpan<Long64_t>(reinterpret_cast<const Long64_t *>(fData + fDirectory[collection].offsets), fHeader->entries + 1);
+}
+
+//------------------------------------------------------------------------------
+
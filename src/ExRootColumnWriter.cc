@@ -0,0 +1,144 @@
+
+/** \class ExRootColumnWriter
+ *
+ *  Writes PT, Eta, Phi and BTag of reconstructed objects into a flat
+ *  columnar file that ExRootColumnReader maps into memory.
+ *
+ */
+
+#include "ExRootAnalysis/ExRootColumnWriter.h"
+
+#include <string.h>
+#include <stdio.h>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+ExRootColumnWriter::ExRootColumnWriter(const char *fileName) :
+  fFileName(fileName), fEntries(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+ExRootColumnWriter::~ExRootColumnWriter()
+{
+}
+
+//------------------------------------------------------------------------------
+
+Int_t ExRootColumnWriter::NewCollection(const char *name)
+{
+  Collection collection;
+  collection.name = name;
+  // offset of the first event
+  collection.offsets.push_back(0);
+  fCollections.push_back(collection);
+  return fCollections.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootColumnWriter::Fill()
+{
+  vector<Collection>::iterator itCollections;
+
+  for(itCollections = fCollections.begin(); itCollections != fCollections.end(); ++itCollections)
+  {
+    itCollections->offsets.push_back(itCollections->pt.size());
+  }
+
+  ++fEntries;
+}
+
+//------------------------------------------------------------------------------
+
+static Long64_t Align(Long64_t position)
+{
+  return (position + ExRootColumnWriter::kAlignment - 1)/ExRootColumnWriter::kAlignment*ExRootColumnWriter::kAlignment;
+}
+
+//------------------------------------------------------------------------------
+
+static Bool_t WriteSection(FILE *file, Long64_t position, const void *data, size_t size)
+{
+  static const char padding[ExRootColumnWriter::kAlignment] = {0};
+  Long64_t current = ftello(file);
+
+  if(current < position && fwrite(padding, 1, position - current, file) != size_t(position - current)) return kFALSE;
+
+  return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootColumnWriter::Write()
+{
+  ExRootColumnHeader header;
+  vector<ExRootColumnDirectory> directory(fCollections.size());
+  Long64_t position, objects;
+  size_t i;
+  Bool_t good;
+  FILE *file;
+
+  memset(&header, 0, sizeof(header));
+  strncpy(header.magic, "ExRootC", sizeof(header.magic));
+  header.version = ExRootColumnHeader::kVersion;
+  header.byteOrder = ExRootColumnHeader::kByteOrder;
+  header.collections = fCollections.size();
+  header.entries = fEntries;
+
+  position = sizeof(header) + directory.size()*sizeof(ExRootColumnDirectory);
+
+  for(i = 0; i < fCollections.size(); ++i)
+  {
+    Collection &collection = fCollections[i];
+    ExRootColumnDirectory &entry = directory[i];
+
+    objects = collection.pt.size();
+
+    memset(&entry, 0, sizeof(entry));
+    strncpy(entry.name, collection.name.c_str(), ExRootColumnDirectory::kNameSize - 1);
+    entry.objects = objects;
+
+    entry.offsets = position = Align(position);
+    position += (fEntries + 1)*sizeof(Long64_t);
+    entry.pt = position = Align(position);
+    position += objects*sizeof(Float_t);
+    entry.eta = position = Align(position);
+    position += objects*sizeof(Float_t);
+    entry.phi = position = Align(position);
+    position += objects*sizeof(Float_t);
+    entry.btag = position = Align(position);
+    position += objects*sizeof(Int_t);
+  }
+
+  file = fopen(fFileName.c_str(), "wb");
+  if(!file) return kFALSE;
+
+  good = fwrite(&header, sizeof(header), 1, file) == 1;
+  if(!directory.empty())
+  {
+    good = good && fwrite(&directory[0], sizeof(ExRootColumnDirectory), directory.size(), file) == directory.size();
+  }
+
+  for(i = 0; good && i < fCollections.size(); ++i)
+  {
+    Collection &collection = fCollections[i];
+    ExRootColumnDirectory &entry = directory[i];
+
+    good = WriteSection(file, entry.offsets, &collection.offsets[0], collection.offsets.size()*sizeof(Long64_t))
+      && WriteSection(file, entry.pt, entry.objects ? &collection.pt[0] : 0, entry.objects*sizeof(Float_t))
+      && WriteSection(file, entry.eta, entry.objects ? &collection.eta[0] : 0, entry.objects*sizeof(Float_t))
+      && WriteSection(file, entry.phi, entry.objects ? &collection.phi[0] : 0, entry.objects*sizeof(Float_t))
+      && WriteSection(file, entry.btag, entry.objects ? &collection.btag[0] : 0, entry.objects*sizeof(Int_t));
+  }
+
+  if(fclose(file) != 0) good = kFALSE;
+
+  return good;
+}
+
+//------------------------------------------------------------------------------
+
@@ -0,0 +1,168 @@
+
+/** \class ExRootEventSinks
+ *
+ *  Pipeline sinks writing LHEF and STDHEP events into ROOT trees.
+ *
+ */
+
+#include "ExRootAnalysis/ExRootEventSinks.h"
+
+#include "ExRootAnalysis/ExRootLHEFReader.h"
+#include "ExRootAnalysis/ExRootTreeWriter.h"
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+#include "ExRootAnalysis/ExRootClasses.h"
+#include "ExRootAnalysis/ExRootCopy.h"
+
+#include "TObjArray.h"
+#include "TObjString.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+ExRootLHEFTreeSink::ExRootLHEFTreeSink(ExRootTreeWriter *treeWriter, ExRootLHEFReader *reader) :
+  fTreeWriter(treeWriter), fReader(reader), fBranchRwgt(0), fEventCounter(0)
+{
+  fBranchEvent = treeWriter->NewBranch("Event", TRootLHEFEvent::Class());
+  if(reader->GetWeightStorage() == ExRootLHEFReader::kWeightObjects)
+  {
+    fBranchRwgt = treeWriter->NewBranch<TRootWeight>("Rwgt");
+  }
+  fBranchParticle = treeWriter->NewBranch<TRootLHEFParticle>("Particle");
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootLHEFTreeSink::Write(ExRootLHEFEventData &data)
+{
+  Copy(data);
+  Fill();
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootLHEFTreeSink::Copy(ExRootLHEFEventData &data)
+{
+  ++fEventCounter;
+
+  // the header is complete with the first event, the run information
+  // and the weight IDs are stored once with the tree
+  if(fEventCounter == 1) WriteHeader();
+
+  ExRootCopy(data.event, *static_cast<TRootLHEFEvent *>(fBranchEvent->NewEntry()));
+  if(fBranchRwgt) ExRootCopy(data.weights, fBranchRwgt);
+  ExRootCopy(data.particles, fBranchParticle);
+
+  if(!fWeightDouble.empty() && data.weightDouble.size() == fWeightDouble.size())
+  {
+    copy(data.weightDouble.begin(), data.weightDouble.end(), fWeightDouble.begin());
+  }
+  if(!fWeightFloat.empty() && data.weightFloat.size() == fWeightFloat.size())
+  {
+    copy(data.weightFloat.begin(), data.weightFloat.end(), fWeightFloat.begin());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootLHEFTreeSink::Fill()
+{
+  fTreeWriter->Fill();
+  fTreeWriter->Clear();
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootLHEFTreeSink::WriteHeader()
+{
+  TObjArray *weightIDs;
+  Int_t size = fReader->GetWeightArraySize();
+  size_t i;
+
+  if(fReader->GetRun())
+  {
+    fTreeWriter->AddUserInfo(new TRootLHEFRun(*fReader->GetRun()));
+  }
+
+  if(fBranchRwgt || size == 0) return;
+
+  // the leaf exists already if the tree continues in a new file
+  if(fReader->GetWeightStorage() == ExRootLHEFReader::kWeightDouble)
+  {
+    if(fWeightDouble.empty())
+    {
+      fWeightDouble.resize(size);
+      fTreeWriter->NewLeaf("Rwgt", &fWeightDouble[0], Form("Rwgt[%d]/D", size));
+    }
+    else if(Int_t(fWeightDouble.size()) != size)
+    {
+      throw runtime_error("number of weights differs from the previous file");
+    }
+  }
+  else
+  {
+    if(fWeightFloat.empty())
+    {
+      fWeightFloat.resize(size);
+      fTreeWriter->NewLeaf("Rwgt", &fWeightFloat[0], Form("Rwgt[%d]/F", size));
+    }
+    else if(Int_t(fWeightFloat.size()) != size)
+    {
+      throw runtime_error("number of weights differs from the previous file");
+    }
+  }
+
+  weightIDs = new TObjArray;
+  weightIDs->SetName("WeightIDs");
+  weightIDs->SetOwner();
+  for(i = 0; i < fReader->GetWeightIDs().size(); ++i)
+  {
+    weightIDs->Add(new TObjString(fReader->GetWeightIDs()[i].c_str()));
+  }
+  fTreeWriter->AddUserInfo(weightIDs);
+}
+
+//------------------------------------------------------------------------------
+
+ExRootSTDHEPTreeSink::ExRootSTDHEPTreeSink(ExRootTreeWriter *treeWriter) :
+  fTreeWriter(treeWriter), fEventCounter(0)
+{
+  // information about generated event
+  fBranchGenEvent = treeWriter->NewBranch("Event", TRootLHEFEvent::Class());
+  // generated particles from HEPEVT
+  fBranchGenParticle = treeWriter->NewBranch<TRootGenParticle>("GenParticle");
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootSTDHEPTreeSink::Write(ExRootSTDHEPEventData &data)
+{
+  Copy(data);
+  Fill();
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootSTDHEPTreeSink::Copy(ExRootSTDHEPEventData &data)
+{
+  ++fEventCounter;
+
+  ExRootCopy(data.event, *static_cast<TRootLHEFEvent *>(fBranchGenEvent->NewEntry()));
+  ExRootCopy(data.particles, fBranchGenParticle);
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootSTDHEPTreeSink::Fill()
+{
+  fTreeWriter->Fill();
+  fTreeWriter->Clear();
+}
+
+//------------------------------------------------------------------------------
+
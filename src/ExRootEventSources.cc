@@ -0,0 +1,99 @@
+
+/** \class ExRootEventSources
+ *
+ *  Pipeline sources reading events with ExRootLHEFReader and
+ *  ExRootSTDHEPReader.
+ *
+ */
+
+#include "ExRootAnalysis/ExRootEventSources.h"
+
+#include "ExRootAnalysis/ExRootLHEFReader.h"
+#include "ExRootAnalysis/ExRootSTDHEPReader.h"
+#include "ExRootAnalysis/ExRootTimer.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+ExRootLHEFSource::ExRootLHEFSource(ExRootLHEFReader *reader) :
+  fReader(reader), fEventCounter(0), fCycles(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootLHEFSource::Read(ExRootLHEFEventData &data)
+{
+  ULong64_t start = ExRootTimer::Cycles();
+  Int_t size;
+
+  data.particles.clear();
+  data.weights.clear();
+  data.weightDouble.clear();
+  data.weightFloat.clear();
+
+  fReader->Clear();
+  while(fReader->ReadBlock(data.particles))
+  {
+    if(!fReader->EventReady()) continue;
+
+    fReader->AnalyzeEvent(data.event, ++fEventCounter);
+
+    // the arrays of the reader are overwritten by the next event
+    size = fReader->GetWeightArraySize();
+    if(fReader->GetWeightStorage() == ExRootLHEFReader::kWeightObjects)
+    {
+      fReader->AnalyzeRwgt(data.weights);
+    }
+    else if(fReader->GetWeightStorage() == ExRootLHEFReader::kWeightDouble && size > 0)
+    {
+      const Double_t *array = static_cast<const Double_t *>(fReader->GetWeightArray());
+      data.weightDouble.assign(array, array + size);
+    }
+    else if(size > 0)
+    {
+      const Float_t *array = static_cast<const Float_t *>(fReader->GetWeightArray());
+      data.weightFloat.assign(array, array + size);
+    }
+
+    fCycles += ExRootTimer::Cycles() - start;
+    return kTRUE;
+  }
+
+  fCycles += ExRootTimer::Cycles() - start;
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootSTDHEPSource::ExRootSTDHEPSource(ExRootSTDHEPReader *reader) :
+  fReader(reader), fEventCounter(0), fCycles(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootSTDHEPSource::Read(ExRootSTDHEPEventData &data)
+{
+  ULong64_t start = ExRootTimer::Cycles();
+
+  data.particles.clear();
+
+  fReader->Clear();
+  while(fReader->ReadBlock(data.particles))
+  {
+    if(!fReader->EventReady()) continue;
+
+    fReader->AnalyzeEvent(data.event, ++fEventCounter);
+
+    fCycles += ExRootTimer::Cycles() - start;
+    return kTRUE;
+  }
+
+  fCycles += ExRootTimer::Cycles() - start;
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
@@ -43,7 +43,7 @@ ExRootFactory::~ExRootFactory()
 void ExRootFactory::Clear()
 {
   map<const TClass *, ExRootTreeBranch *>::iterator it_map;
-  for(it_map = fMakers.begin(); it_map != fMakers.begin(); ++it_map)
+  for(it_map = fMakers.begin(); it_map != fMakers.end(); ++it_map)
   {
     it_map->second->Clear();
   }
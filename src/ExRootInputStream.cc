@@ -0,0 +1,337 @@
+
+/** \class ExRootInputStream
+ *
+ *  Reads a plain, gzip or zstd compressed file on a separate thread and
+ *  hands the decompressed data out in large blocks.
+ *
+ */
+
+#include "ExRootAnalysis/ExRootInputStream.h"
+
+#include <string.h>
+
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+ExRootInputStream::ExRootInputStream(FILE *inputFile) :
+  fInputFile(inputFile), fBlocks(kBlocks), fCurrent(0),
+  fFinished(kFALSE), fStop(kFALSE)
+{
+  vector<Block>::iterator itBlocks;
+
+  for(itBlocks = fBlocks.begin(); itBlocks != fBlocks.end(); ++itBlocks)
+  {
+    itBlocks->data.resize(kBlockSize);
+    itBlocks->size = 0;
+    fFree.push_back(&(*itBlocks));
+  }
+
+  fThread = thread(&ExRootInputStream::Decode, this);
+}
+
+//------------------------------------------------------------------------------
+
+ExRootInputStream::~ExRootInputStream()
+{
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fFreeCondition.notify_all();
+  fThread.join();
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootInputStream::NextBlock(char *&data, size_t &size)
+{
+  unique_lock<mutex> lock(fMutex);
+
+  if(fCurrent)
+  {
+    fFree.push_back(fCurrent);
+    fCurrent = 0;
+    fFreeCondition.notify_one();
+  }
+
+  while(!fFinished && fReady.empty()) fReadyCondition.wait(lock);
+
+  if(fReady.empty()) return kFALSE;
+
+  fCurrent = fReady.front();
+  fReady.pop_front();
+
+  data = &fCurrent->data[0];
+  size = fCurrent->size;
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootInputStream::Block *ExRootInputStream::AcquireBlock()
+{
+  Block *block;
+  unique_lock<mutex> lock(fMutex);
+
+  while(!fStop && fFree.empty()) fFreeCondition.wait(lock);
+
+  if(fStop) return 0;
+
+  block = fFree.front();
+  fFree.pop_front();
+  block->size = 0;
+
+  return block;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootInputStream::PublishBlock(Block *block)
+{
+  {
+    lock_guard<mutex> lock(fMutex);
+    if(block->size > 0) fReady.push_back(block);
+    else fFree.push_back(block);
+  }
+  fReadyCondition.notify_one();
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootInputStream::SetError(const string &error)
+{
+  lock_guard<mutex> lock(fMutex);
+  fError = error;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootInputStream::Decode()
+{
+  vector<char> input(kInputSize);
+  size_t size;
+  const unsigned char *magic = reinterpret_cast<const unsigned char *>(&input[0]);
+
+  size = fread(&input[0], 1, kInputSize, fInputFile);
+
+  if(size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+  {
+    DecodeGzip(&input[0], size);
+  }
+  else if(size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+  {
+    DecodeZstd(&input[0], size);
+  }
+  else
+  {
+    DecodePlain(&input[0], size);
+  }
+
+  if(ferror(fInputFile)) SetError("can't read input file");
+
+  {
+    lock_guard<mutex> lock(fMutex);
+    fFinished = kTRUE;
+  }
+  fReadyCondition.notify_all();
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootInputStream::DecodePlain(const char *input, size_t size)
+{
+  Block *block = AcquireBlock();
+  if(!block) return;
+
+  memcpy(&block->data[0], input, size);
+  block->size = size;
+
+  while(true)
+  {
+    block->size += fread(&block->data[block->size], 1, kBlockSize - block->size, fInputFile);
+
+    if(block->size < size_t(kBlockSize))
+    {
+      PublishBlock(block);
+      return;
+    }
+
+    PublishBlock(block);
+    block = AcquireBlock();
+    if(!block) return;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootInputStream::DecodeGzip(char *input, size_t size)
+{
+  z_stream stream;
+  Block *block;
+  Bool_t member = kFALSE, full = kFALSE;
+  int rc;
+
+  memset(&stream, 0, sizeof(stream));
+
+  // 15 + 32: maximum window, gzip or zlib header detected automatically
+  if(inflateInit2(&stream, 15 + 32) != Z_OK)
+  {
+    SetError("can't initialize zlib");
+    return;
+  }
+
+  block = AcquireBlock();
+
+  stream.next_in = reinterpret_cast<Bytef *>(input);
+  stream.avail_in = size;
+
+  while(block)
+  {
+    // a full block may leave output inside zlib, it is taken
+    // before more input is read
+
+    if(stream.avail_in == 0 && !full)
+    {
+      stream.next_in = reinterpret_cast<Bytef *>(input);
+      stream.avail_in = fread(input, 1, kInputSize, fInputFile);
+      if(stream.avail_in == 0) break;
+    }
+
+    // zero bytes after a complete member are padding (e.g. from tape
+    // or block devices) and end the input as with gzip -d
+
+    if(!member && !full)
+    {
+      while(stream.avail_in > 0 && *stream.next_in == 0)
+      {
+        ++stream.next_in;
+        --stream.avail_in;
+      }
+      if(stream.avail_in == 0) continue;
+    }
+
+    stream.next_out = reinterpret_cast<Bytef *>(&block->data[block->size]);
+    stream.avail_out = kBlockSize - block->size;
+
+    rc = inflate(&stream, Z_NO_FLUSH);
+
+    block->size = kBlockSize - stream.avail_out;
+    full = (stream.avail_out == 0);
+
+    if(rc == Z_STREAM_END)
+    {
+      // the next member, if any, starts right after this one
+      inflateReset(&stream);
+      member = kFALSE;
+    }
+    else if(rc == Z_OK)
+    {
+      member = kTRUE;
+    }
+    else if(rc != Z_BUF_ERROR)
+    {
+      SetError(string("invalid gzip data: ") + (stream.msg ? stream.msg : "unknown error"));
+      member = kFALSE;
+      break;
+    }
+
+    if(block->size == size_t(kBlockSize))
+    {
+      PublishBlock(block);
+      block = AcquireBlock();
+    }
+  }
+
+  if(block) PublishBlock(block);
+
+  if(member && !ferror(fInputFile)) SetError("truncated gzip data");
+
+  inflateEnd(&stream);
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootInputStream::DecodeZstd(char *input, size_t size)
+{
+#ifdef HAVE_ZSTD
+  ZSTD_DStream *stream;
+  ZSTD_inBuffer in;
+  ZSTD_outBuffer out;
+  Block *block;
+  Bool_t full = kFALSE;
+  size_t rc, pending = 0, inPos, outPos;
+
+  stream = ZSTD_createDStream();
+  if(!stream || ZSTD_isError(ZSTD_initDStream(stream)))
+  {
+    if(stream) ZSTD_freeDStream(stream);
+    SetError("can't initialize zstd");
+    return;
+  }
+
+  block = AcquireBlock();
+
+  in.src = input;
+  in.size = size;
+  in.pos = 0;
+
+  while(block)
+  {
+    if(in.pos == in.size && !full)
+    {
+      in.size = fread(input, 1, kInputSize, fInputFile);
+      in.pos = 0;
+      if(in.size == 0) break;
+    }
+
+    out.dst = &block->data[0];
+    out.size = kBlockSize;
+    out.pos = block->size;
+
+    // continues with the next frame after the end of a frame,
+    // rc is 0 only when a frame is complete
+    inPos = in.pos;
+    outPos = out.pos;
+    rc = ZSTD_decompressStream(stream, &out, &in);
+
+    if(ZSTD_isError(rc))
+    {
+      SetError(string("invalid zstd data: ") + ZSTD_getErrorName(rc));
+      pending = 0;
+      break;
+    }
+
+    block->size = out.pos;
+    full = (out.pos == out.size);
+    if(in.pos != inPos || out.pos != outPos) pending = rc;
+
+    if(block->size == size_t(kBlockSize))
+    {
+      PublishBlock(block);
+      block = AcquireBlock();
+    }
+  }
+
+  if(block) PublishBlock(block);
+
+  if(pending != 0 && !ferror(fInputFile)) SetError("truncated zstd data");
+
+  ZSTD_freeDStream(stream);
+#else
+  // the first bytes read by Decode are not needed without zstd
+  (void) input;
+  (void) size;
+  SetError("zstd input is not supported, rebuild with ZSTD=1");
+#endif
+}
+
+//------------------------------------------------------------------------------
+
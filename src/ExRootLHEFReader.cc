@@ -19,40 +19,130 @@
 #include <sstream>
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "TLorentzVector.h"
 
 #include "ExRootAnalysis/ExRootClasses.h"
 #include "ExRootAnalysis/ExRootFactory.h"
+#include "ExRootAnalysis/ExRootInputStream.h"
 #include "ExRootAnalysis/ExRootStream.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
 using namespace std;
 
-static const int kBufferSize  = 1024;
-
 //---------------------------------------------------------------------------
 
 ExRootLHEFReader::ExRootLHEFReader() :
-  fInputFile(0), fBuffer(0),
-  fEventReady(kFALSE), fEventCounter(-1), fParticleCounter(-1)
+  fInputFile(0), fInputStream(0), fBlock(0), fBlockSize(0), fBlockPosition(0),
+  fLine(0),
+  fEventReady(kFALSE), fEventCounter(-1), fParticleCounter(-1),
+  fWeightStorage(kWeightObjects), fWeightCounter(0), fEventNumber(0),
+  fState(kOutside), fProcessCounter(-1), fInitReady(false), fRun(0)
 {
-  fBuffer = new char[kBufferSize];
+  fRun = new TRootLHEFRun;
 }
 
 //---------------------------------------------------------------------------
 
 ExRootLHEFReader::~ExRootLHEFReader()
 {
-  if(fBuffer) delete[] fBuffer;
+  if(fInputStream) delete fInputStream;
+  if(fRun) delete fRun;
 }
 
 //---------------------------------------------------------------------------
 
 void ExRootLHEFReader::SetInputFile(FILE *inputFile)
 {
+  // the previous decoder thread stops before its file is closed
+  if(fInputStream) delete fInputStream;
+
   fInputFile = inputFile;
+  fInputStream = inputFile ? new ExRootInputStream(inputFile) : 0;
+  fBlock = 0;
+  fBlockSize = 0;
+  fBlockPosition = 0;
+  fEventNumber = 0;
+
+  // a new file starts outside of any block, also if the previous one
+  // ended inside an event, and has its own <init> and <initrwgt>
+  fState = kOutside;
+  fProcessCounter = -1;
+  fInitReady = false;
+  fWeightIDs.clear();
+  fWeightDouble.clear();
+  fWeightFloat.clear();
+  Clear();
+}
+
+//---------------------------------------------------------------------------
+
+bool ExRootLHEFReader::ReadLine()
+{
+  char *begin, *end;
+  size_t size;
+  bool crossing = false;
+
+  while(true)
+  {
+    if(fBlockPosition == fBlockSize)
+    {
+      if(!fInputStream || !fInputStream->NextBlock(fBlock, fBlockSize))
+      {
+        fBlockSize = fBlockPosition = 0;
+        if(fInputStream && !fInputStream->GetError().empty())
+        {
+          cerr << "** ERROR: " << fInputStream->GetError() << endl;
+          return kFALSE;
+        }
+        if(!crossing) return kFALSE;
+        break;
+      }
+      fBlockPosition = 0;
+    }
+
+    begin = fBlock + fBlockPosition;
+    end = static_cast<char *>(memchr(begin, '\n', fBlockSize - fBlockPosition));
+
+    // lines inside a block are used in place
+
+    if(end && !crossing)
+    {
+      *end = '\0';
+      fLine = begin;
+      fBlockPosition += end - begin + 1;
+      return kTRUE;
+    }
+
+    // lines crossing the end of a block are collected in fBuffer,
+    // whatever their length
+
+    if(!crossing)
+    {
+      fBuffer.clear();
+      crossing = true;
+    }
+
+    size = end ? end - begin : fBlockSize - fBlockPosition;
+
+    fBuffer.insert(fBuffer.end(), begin, begin + size);
+    fBlockPosition += size;
+
+    if(end)
+    {
+      ++fBlockPosition;
+      break;
+    }
+  }
+
+  fBuffer.push_back('\0');
+  fLine = &fBuffer[0];
+
+  return kTRUE;
 }
 
 //---------------------------------------------------------------------------
@@ -63,6 +153,20 @@ void ExRootLHEFReader::Clear()
   fEventCounter = -1;
   fParticleCounter = -1;
   fRwgtList.clear();
+
+  // weights missing in an event stay 0 in the array mode
+  fWeightCounter = 0;
+  if(!fWeightDouble.empty()) memset(&fWeightDouble[0], 0, fWeightDouble.size()*sizeof(double));
+  if(!fWeightFloat.empty()) memset(&fWeightFloat[0], 0, fWeightFloat.size()*sizeof(float));
+}
+
+//---------------------------------------------------------------------------
+
+void *ExRootLHEFReader::GetWeightArray()
+{
+  if(fWeightStorage == kWeightDouble && !fWeightDouble.empty()) return &fWeightDouble[0];
+  if(fWeightStorage == kWeightFloat && !fWeightFloat.empty()) return &fWeightFloat[0];
+  return 0;
 }
 
 //---------------------------------------------------------------------------
@@ -74,22 +178,165 @@ bool ExRootLHEFReader::EventReady()
 
 //---------------------------------------------------------------------------
 
+// particles go either to a branch or to a vector of plain structures
+
+template <typename T> struct ParticleOutput;
+
+template <> struct ParticleOutput<ExRootTreeBranch>
+{
+  typedef TRootLHEFParticle Particle;
+  static Particle *New(ExRootTreeBranch *branch) { return static_cast<Particle *>(branch->NewEntry()); }
+};
+
+template <> struct ParticleOutput< vector<ExRootLHEFParticle> >
+{
+  typedef ExRootLHEFParticle Particle;
+  static Particle *New(vector<Particle> *particles)
+  {
+    particles->push_back(Particle());
+    return &particles->back();
+  }
+};
+
+//---------------------------------------------------------------------------
+
 bool ExRootLHEFReader::ReadBlock(ExRootTreeBranch *branch)
 {
-  int rc;
-  char *pch;
-  double weight;
+  return Read(branch);
+}
+
+//---------------------------------------------------------------------------
 
-  if(!fgets(fBuffer, kBufferSize, fInputFile)) return kFALSE;
+bool ExRootLHEFReader::ReadBlock(vector<ExRootLHEFParticle> &particles)
+{
+  return Read(&particles);
+}
 
-  if(strstr(fBuffer, "<event>"))
+//---------------------------------------------------------------------------
+
+bool ExRootLHEFReader::ReadEvent(ExRootLHEFEventView &view)
+{
+  Clear();
+  fParticles.clear();
+
+  while(ReadBlock(fParticles))
+  {
+    if(!EventReady()) continue;
+
+    AnalyzeEvent(fEvent, ++fEventNumber);
+
+    view.event = &fEvent;
+    view.particles = ExRootSpan<ExRootLHEFParticle>(fParticles.empty() ? 0 : &fParticles[0], fParticles.size());
+
+    view.weights = ExRootSpan<double>();
+    view.weightsFloat = ExRootSpan<float>();
+
+    if(fWeightStorage == kWeightObjects)
+    {
+      view.weights = ExRootSpan<double>(fRwgtList.empty() ? 0 : &fRwgtList[0], fRwgtList.size());
+    }
+    else if(fWeightStorage == kWeightDouble)
+    {
+      view.weights = ExRootSpan<double>(fWeightDouble.empty() ? 0 : &fWeightDouble[0], fWeightDouble.size());
+    }
+    else
+    {
+      view.weightsFloat = ExRootSpan<float>(fWeightFloat.empty() ? 0 : &fWeightFloat[0], fWeightFloat.size());
+    }
+
+    return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//---------------------------------------------------------------------------
+
+long long ExRootLHEFReader::ReadEvents(ExRootEventHandler<ExRootLHEFEventView> *handler)
+{
+  ExRootLHEFEventView view;
+  long long events = 0;
+
+  while(ReadEvent(view))
+  {
+    ++events;
+    if(!handler->ProcessEvent(view)) break;
+  }
+
+  return events;
+}
+
+//---------------------------------------------------------------------------
+
+template <typename T>
+bool ExRootLHEFReader::Read(T *output)
+{
+  EXROOT_PROFILE_SCOPE("ExRootLHEFReader::ReadBlock");
+
+  char *tag;
+
+  if(!ReadLine()) return kFALSE;
+
+  switch(fState)
+  {
+    case kEvent:
+      return ReadEventLine(output);
+    case kInit:
+      return ReadInitLine();
+    case kInitRwgt:
+      return ReadInitRwgtLine(fLine);
+    default:
+      break;
+  }
+
+  // outside of the blocks most lines are banner text without tags,
+  // a single search for '<' is enough to skip them
+
+  tag = strchr(fLine, '<');
+  if(!tag) return kTRUE;
+
+  if(strncmp(tag, "<event>", 7) == 0 || strncmp(tag, "<event ", 7) == 0)
   {
     Clear();
     fEventCounter = 1;
+    fState = kEvent;
+  }
+  else if(strncmp(tag, "<initrwgt>", 10) == 0)
+  {
+    fWeightIDs.clear();
+    fState = kInitRwgt;
+    // the declarations may follow on the same line
+    return ReadInitRwgtLine(tag + 10);
+  }
+  else if(strncmp(tag, "<init>", 6) == 0 || strncmp(tag, "<init ", 6) == 0)
+  {
+    fProcessCounter = -1;
+    fInitReady = false;
+    fState = kInit;
+  }
+  else if(strncmp(tag, "<header", 7) == 0)
+  {
+    fState = kHeader;
+  }
+  else if(strncmp(tag, "</header>", 9) == 0)
+  {
+    fState = kOutside;
   }
-  else if(fEventCounter > 0)
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+template <typename T>
+bool ExRootLHEFReader::ReadEventLine(T *output)
+{
+  const char *tag;
+  int rc;
+
+  if(fEventCounter > 0)
   {
-    ExRootStream bufferStream(fBuffer);
+    ExRootStream bufferStream(fLine);
 
     rc = bufferStream.ReadInt(fNparticles)
       && bufferStream.ReadInt(fProcessID)
@@ -108,7 +355,7 @@ bool ExRootLHEFReader::ReadBlock(ExRootTreeBranch *branch)
   }
   else if(fParticleCounter > 0)
   {
-    ExRootStream bufferStream(fBuffer);
+    ExRootStream bufferStream(fLine);
 
     rc = bufferStream.ReadInt(fPID)
       && bufferStream.ReadInt(fStatus)
@@ -130,33 +377,193 @@ bool ExRootLHEFReader::ReadBlock(ExRootTreeBranch *branch)
       return kFALSE;
     }
 
-    AnalyzeParticle(branch);
+    FillParticle(ParticleOutput<T>::New(output));
 
     --fParticleCounter;
   }
-  else if(strstr(fBuffer, "<wgt"))
+  else
   {
-    pch = strstr(fBuffer, ">");
-    if(!pch)
+    // <rwgt> blocks may put all weights and even </event> on one line
+
+    tag = strstr(fLine, "<wgt");
+    if(tag && !AnalyzeWeight(tag)) return kFALSE;
+
+    if(strstr(fLine, "</event>"))
     {
-      cerr << "** ERROR: " << "invalid weight format" << endl;
+      fEventReady = kTRUE;
+      fState = kOutside;
+    }
+  }
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+bool ExRootLHEFReader::ReadInitLine()
+{
+  int rc, processID;
+  double crossSection, crossSectionError, maxWeight;
+
+  if(fProcessCounter < 0)
+  {
+    ExRootStream bufferStream(fLine);
+
+    rc = bufferStream.ReadInt(fRun->BeamPID[0])
+      && bufferStream.ReadInt(fRun->BeamPID[1])
+      && bufferStream.ReadDbl(fRun->BeamEnergy[0])
+      && bufferStream.ReadDbl(fRun->BeamEnergy[1])
+      && bufferStream.ReadInt(fRun->PDFGroup[0])
+      && bufferStream.ReadInt(fRun->PDFGroup[1])
+      && bufferStream.ReadInt(fRun->PDFSet[0])
+      && bufferStream.ReadInt(fRun->PDFSet[1])
+      && bufferStream.ReadInt(fRun->WeightingStrategy)
+      && bufferStream.ReadInt(fRun->Nprocesses);
+
+    if(!rc || fRun->Nprocesses < 0)
+    {
+      cerr << "** ERROR: " << "invalid init format" << endl;
       return kFALSE;
     }
 
-    ExRootStream bufferStream(pch + 1);
-    rc = bufferStream.ReadDbl(weight);
+    fRun->CrossSection.clear();
+    fRun->CrossSectionError.clear();
+    fRun->MaxWeight.clear();
+    fRun->ProcessID.clear();
+
+    fProcessCounter = fRun->Nprocesses;
+  }
+  else if(fProcessCounter > 0)
+  {
+    ExRootStream bufferStream(fLine);
+
+    rc = bufferStream.ReadDbl(crossSection)
+      && bufferStream.ReadDbl(crossSectionError)
+      && bufferStream.ReadDbl(maxWeight)
+      && bufferStream.ReadInt(processID);
 
     if(!rc)
     {
-      cerr << "** ERROR: " << "invalid weight format" << endl;
+      cerr << "** ERROR: " << "invalid init format" << endl;
       return kFALSE;
     }
 
-    fRwgtList.push_back(weight);
+    fRun->CrossSection.push_back(crossSection);
+    fRun->CrossSectionError.push_back(crossSectionError);
+    fRun->MaxWeight.push_back(maxWeight);
+    fRun->ProcessID.push_back(processID);
+
+    --fProcessCounter;
   }
-  else if(strstr(fBuffer, "</event>"))
+  else if(strstr(fLine, "</init>"))
   {
-    fEventReady = kTRUE;
+    fInitReady = true;
+    fState = kOutside;
+  }
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+bool ExRootLHEFReader::ReadInitRwgtLine(const char *line)
+{
+  const char *tag;
+
+  tag = strstr(line, "<weight ");
+  if(tag && !AnalyzeWeightID(tag)) return kFALSE;
+
+  if(strstr(line, "</initrwgt>"))
+  {
+    fState = kHeader;
+    fWeightDouble.assign(fWeightStorage == kWeightDouble ? fWeightIDs.size() : 0, 0.0);
+    fWeightFloat.assign(fWeightStorage == kWeightFloat ? fWeightIDs.size() : 0, 0.0);
+  }
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+bool ExRootLHEFReader::AnalyzeWeightID(const char *tag)
+{
+  const char *begin, *end;
+
+  // <weight id="name"> or <weight id='name'>, several declarations
+  // may share one line
+
+  while(tag)
+  {
+    begin = strstr(tag, "id=");
+    if(!begin || (begin[3] != '"' && begin[3] != '\''))
+    {
+      cerr << "** ERROR: " << "invalid weight declaration" << endl;
+      return kFALSE;
+    }
+
+    begin += 4;
+    end = strchr(begin, begin[-1]);
+    if(!end)
+    {
+      cerr << "** ERROR: " << "invalid weight declaration" << endl;
+      return kFALSE;
+    }
+
+    fWeightIDs.push_back(string(begin, end));
+
+    tag = strstr(end, "<weight ");
+  }
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+bool ExRootLHEFReader::AnalyzeWeight(const char *tag)
+{
+  const char *begin;
+  char *end;
+  double weight;
+
+  // <wgt id='name'> value </wgt>, the weights follow the order of <initrwgt>,
+  // several weights may share one line
+
+  while(tag)
+  {
+    begin = strchr(tag, '>');
+    if(!begin)
+    {
+      cerr << "** ERROR: " << "invalid weight format" << endl;
+      return kFALSE;
+    }
+
+    weight = strtod(begin + 1, &end);
+    if(end == begin + 1)
+    {
+      cerr << "** ERROR: " << "invalid weight format" << endl;
+      return kFALSE;
+    }
+
+    switch(fWeightStorage)
+    {
+      case kWeightObjects:
+        fRwgtList.push_back(weight);
+        break;
+      case kWeightDouble:
+      case kWeightFloat:
+        if(fWeightCounter >= int(fWeightIDs.size()))
+        {
+          cerr << "** ERROR: " << "more weights than declared in <initrwgt>" << endl;
+          return kFALSE;
+        }
+        if(fWeightStorage == kWeightDouble) fWeightDouble[fWeightCounter] = weight;
+        else fWeightFloat[fWeightCounter] = weight;
+        break;
+    }
+
+    ++fWeightCounter;
+
+    tag = strstr(end, "<wgt");
   }
 
   return kTRUE;
@@ -166,10 +573,21 @@ bool ExRootLHEFReader::ReadBlock(ExRootTreeBranch *branch)
 
 void ExRootLHEFReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber)
 {
-  TRootLHEFEvent *element;
+  FillEvent(static_cast<TRootLHEFEvent *>(branch->NewEntry()), eventNumber);
+}
 
-  element = static_cast<TRootLHEFEvent *>(branch->NewEntry());
+//---------------------------------------------------------------------------
+
+void ExRootLHEFReader::AnalyzeEvent(ExRootLHEFEvent &event, long long eventNumber)
+{
+  FillEvent(&event, eventNumber);
+}
+
+//---------------------------------------------------------------------------
 
+template <typename T>
+void ExRootLHEFReader::FillEvent(T *element, long long eventNumber)
+{
   element->Number = eventNumber;
 
   element->Nparticles = fNparticles;
@@ -197,15 +615,27 @@ void ExRootLHEFReader::AnalyzeRwgt(ExRootTreeBranch *branch)
 
 //---------------------------------------------------------------------------
 
-void ExRootLHEFReader::AnalyzeParticle(ExRootTreeBranch *branch)
+void ExRootLHEFReader::AnalyzeRwgt(vector<ExRootWeight> &weights)
+{
+  vector<double>::const_iterator itRwgtList;
+
+  for(itRwgtList = fRwgtList.begin(); itRwgtList != fRwgtList.end(); ++itRwgtList)
+  {
+    weights.push_back(ExRootWeight());
+    weights.back().Weight = *itRwgtList;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+template <typename T>
+void ExRootLHEFReader::FillParticle(T *element)
 {
-  TRootLHEFParticle *element;
+  EXROOT_PROFILE_SCOPE("ExRootLHEFReader::AnalyzeParticle");
 
   Double_t signPz, cosTheta;
   TLorentzVector momentum;
 
-  element = static_cast<TRootLHEFParticle*>(branch->NewEntry());
-
   element->PID = fPID;
   element->Status = fStatus;
 
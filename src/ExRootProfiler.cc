@@ -0,0 +1,174 @@
+
+/** \class ExRootProfiler
+ *
+ *  Timing probes for hot paths
+ *
+ */
+
+#include "ExRootAnalysis/ExRootProfiler.h"
+
+#include <mutex>
+#include <vector>
+
+#include <string.h>
+#include <stdio.h>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+  struct ThreadData
+  {
+    ULong64_t calls[ExRootProfiler::kMaxProbes];
+    ULong64_t cycles[ExRootProfiler::kMaxProbes];
+    ULong64_t buckets[ExRootProfiler::kMaxProbes][ExRootProfiler::kBuckets];
+  };
+
+  struct Registry
+  {
+    Registry() : startCycles(0), startTime(0) {}
+
+    mutex lock;
+    vector<const char *> names;
+    vector<ThreadData *> threads;
+    ULong64_t startCycles, startTime;
+  };
+
+  Registry &GetRegistry()
+  {
+    static Registry registry;
+    return registry;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+ExRootProfiler::Probe::Probe(const char *name) :
+  fIndex(-1)
+{
+  Registry &registry = GetRegistry();
+  lock_guard<mutex> guard(registry.lock);
+
+  if(registry.names.empty())
+  {
+    registry.startTime = ExRootTimer::Nanoseconds();
+    registry.startCycles = ExRootTimer::Cycles();
+  }
+
+  if(registry.names.size() < size_t(kMaxProbes))
+  {
+    fIndex = Int_t(registry.names.size());
+    registry.names.push_back(name);
+  }
+  else
+  {
+    fprintf(stderr, "** WARNING: too many timing probes, '%s' is ignored\n", name);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootProfiler::Add(Int_t index, ULong64_t cycles)
+{
+  static thread_local ThreadData *data = 0;
+  Int_t bucket;
+
+  if(index < 0) return;
+
+  if(!data)
+  {
+    Registry &registry = GetRegistry();
+    data = new ThreadData;
+    memset(data, 0, sizeof(ThreadData));
+    lock_guard<mutex> guard(registry.lock);
+    registry.threads.push_back(data);
+  }
+
+  // histogram with logarithmic bins, bin n counts calls
+  // that took between 2^(n-1) and 2^n cycles
+
+#if defined(__GNUC__)
+  bucket = cycles ? 64 - __builtin_clzll(cycles) : 0;
+#else
+  for(bucket = 0; bucket < 64 && (cycles >> bucket); ++bucket);
+#endif
+  if(bucket >= kBuckets) bucket = kBuckets - 1;
+
+  ++data->calls[index];
+  data->cycles[index] += cycles;
+  ++data->buckets[index][bucket];
+}
+
+//------------------------------------------------------------------------------
+
+static Double_t Percentile(const ULong64_t *buckets, ULong64_t calls, Double_t fraction)
+{
+  Int_t bucket;
+  ULong64_t sum = 0;
+
+  for(bucket = 0; bucket < ExRootProfiler::kBuckets; ++bucket)
+  {
+    sum += buckets[bucket];
+    if(sum >= fraction*calls) break;
+  }
+
+  // upper edge of the bin
+  return Double_t(1ULL << (bucket < 63 ? bucket : 63));
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootProfiler::Report(FILE *file)
+{
+  Registry &registry = GetRegistry();
+  lock_guard<mutex> guard(registry.lock);
+
+  size_t probe, thread;
+  Int_t bucket;
+  ULong64_t calls, cycles, buckets[kBuckets];
+  ULong64_t stopTime, stopCycles;
+  Double_t nsPerCycle;
+
+  if(registry.names.empty() || registry.threads.empty()) return;
+
+  stopTime = ExRootTimer::Nanoseconds();
+  stopCycles = ExRootTimer::Cycles();
+  nsPerCycle = (stopCycles > registry.startCycles) ?
+    Double_t(stopTime - registry.startTime)/(stopCycles - registry.startCycles) : 1.0;
+
+  fprintf(file, "** Timing probes, %lu threads\n", (unsigned long)registry.threads.size());
+  fprintf(file, "** %-32s %12s %12s %10s %10s %10s %10s\n",
+    "probe", "calls", "total [s]", "mean [ns]", "p50 [ns]", "p90 [ns]", "p99 [ns]");
+
+  for(probe = 0; probe < registry.names.size(); ++probe)
+  {
+    calls = 0;
+    cycles = 0;
+    memset(buckets, 0, sizeof(buckets));
+
+    for(thread = 0; thread < registry.threads.size(); ++thread)
+    {
+      ThreadData *data = registry.threads[thread];
+      calls += data->calls[probe];
+      cycles += data->cycles[probe];
+      for(bucket = 0; bucket < kBuckets; ++bucket)
+      {
+        buckets[bucket] += data->buckets[probe][bucket];
+      }
+    }
+
+    if(calls == 0) continue;
+
+    fprintf(file, "** %-32s %12llu %12.3f %10.1f %10.0f %10.0f %10.0f\n",
+      registry.names[probe], calls, cycles*nsPerCycle*1.0e-9, cycles*nsPerCycle/calls,
+      Percentile(buckets, calls, 0.5)*nsPerCycle,
+      Percentile(buckets, calls, 0.9)*nsPerCycle,
+      Percentile(buckets, calls, 0.99)*nsPerCycle);
+  }
+
+  fflush(file);
+}
+
+//------------------------------------------------------------------------------
@@ -13,8 +13,6 @@
 
 #include "ExRootAnalysis/ExRootProgressBar.h"
 
-#include "TSystem.h"
-
 #include <iostream>
 
 #include <string.h>
@@ -23,11 +21,20 @@
 using namespace std;
 
 ExRootProgressBar::ExRootProgressBar(Long64_t entries, Int_t width) :
-  fEntries(entries), fEventCounter(0), fWidth(width), fTime(0), fHashes(-1), fBar(0)
+  fEntries(entries), fEventCounter(0), fWidth(width), fTime(0), fHashes(-1), fBar(0),
+  fEvents(0), fBytesRead(0), fBytesWritten(0),
+  fStartCycles(0), fStartTime(0), fNextCycles(0),
+  fStageStart(0)
 {
   fBar = new char[width + 1];
   memset(fBar, '-', width);
   fBar[width] = 0;
+
+  memset(fStageCycles, 0, sizeof(fStageCycles));
+  memset(fStageCalls, 0, sizeof(fStageCalls));
+
+  fStartTime = ExRootTimer::Nanoseconds();
+  fStartCycles = ExRootTimer::Cycles();
 }
 
 //------------------------------------------------------------------------------
@@ -41,9 +48,23 @@ ExRootProgressBar::~ExRootProgressBar()
 
 void ExRootProgressBar::Update(Long64_t entry, Long64_t eventCounter, Bool_t last)
 {
-  ULong64_t time = gSystem->Now();
+  // reading the cycle counter costs a few ns, the clock is only read
+  // when the next update is due
+
+  ULong64_t cycles = ExRootTimer::Cycles();
+
+  fEvents = eventCounter;
+
+  if(cycles < fNextCycles && entry < fEntries && !last) return;
+
+  ULong64_t time = ExRootTimer::Nanoseconds();
 
-  if(time < fTime + 500 && entry < fEntries && !last) return;
+  if(time > fStartTime && cycles > fStartCycles)
+  {
+    fNextCycles = cycles + ULong64_t(Double_t(cycles - fStartCycles)/(time - fStartTime)*5.0e8);
+  }
+
+  if(time < fTime + 500000000 && entry < fEntries && !last) return;
 
   fTime = time;
 
@@ -81,3 +102,56 @@ void ExRootProgressBar::Finish()
 
 //------------------------------------------------------------------------------
 
+void ExRootProgressBar::WriteSummary(const char *fileName)
+{
+  static const char *stageNames[kStages] = {"parse", "kinematics", "fill", "compress"};
+
+  Int_t stage;
+  FILE *file;
+  ULong64_t stopTime = ExRootTimer::Nanoseconds();
+  ULong64_t stopCycles = ExRootTimer::Cycles();
+  Double_t seconds, secondsPerCycle, stageSeconds;
+
+  seconds = (stopTime - fStartTime)*1.0e-9;
+  secondsPerCycle = (stopCycles > fStartCycles) ? seconds/(stopCycles - fStartCycles) : 0.0;
+  if(seconds <= 0.0) seconds = 1.0e-9;
+
+  if(strcmp(fileName, "-") == 0)
+  {
+    file = stdout;
+  }
+  else
+  {
+    file = fopen(fileName, "w");
+    if(!file)
+    {
+      cerr << "** ERROR: can't open '" << fileName << "' for output" << endl;
+      return;
+    }
+  }
+
+  fprintf(file, "{\n");
+  fprintf(file, "  \"events\": %lld,\n", fEvents);
+  fprintf(file, "  \"seconds\": %.6f,\n", seconds);
+  fprintf(file, "  \"events_per_second\": %.3f,\n", fEvents/seconds);
+  fprintf(file, "  \"bytes_read\": %lld,\n", fBytesRead);
+  fprintf(file, "  \"mb_read_per_second\": %.3f,\n", fBytesRead/seconds*1.0e-6);
+  fprintf(file, "  \"bytes_written\": %lld,\n", fBytesWritten);
+  fprintf(file, "  \"mb_written_per_second\": %.3f,\n", fBytesWritten/seconds*1.0e-6);
+  fprintf(file, "  \"stages\": {\n");
+  for(stage = 0; stage < kStages; ++stage)
+  {
+    stageSeconds = fStageCycles[stage]*secondsPerCycle;
+    fprintf(file, "    \"%s\": {\"calls\": %lld, \"seconds\": %.6f, \"ns_per_call\": %.1f}%s\n",
+      stageNames[stage], fStageCalls[stage], stageSeconds,
+      fStageCalls[stage] > 0 ? stageSeconds/fStageCalls[stage]*1.0e9 : 0.0,
+      stage + 1 < kStages ? "," : "");
+  }
+  fprintf(file, "  }\n");
+  fprintf(file, "}\n");
+
+  if(file != stdout) fclose(file);
+  else fflush(file);
+}
+
+//------------------------------------------------------------------------------
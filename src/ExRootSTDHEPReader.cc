@@ -27,6 +27,7 @@
 
 #include "ExRootAnalysis/ExRootClasses.h"
 #include "ExRootAnalysis/ExRootFactory.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
@@ -37,7 +38,7 @@ static const int kBufferSize  = 1000000;
 //---------------------------------------------------------------------------
 
 ExRootSTDHEPReader::ExRootSTDHEPReader() :
-  fInputFile(0), fInputXDR(0), fBuffer(0), fBlockType(-1)
+  fInputFile(0), fInputXDR(0), fBuffer(0), fBlockType(-1), fEventCounter(0)
 {
   fInputXDR = new XDR;
   fBuffer = new char[kBufferSize*96 + 24];
@@ -76,8 +77,85 @@ bool ExRootSTDHEPReader::EventReady()
 
 //---------------------------------------------------------------------------
 
+// particles go either to a branch or to a vector of plain structures
+
+template <typename T> struct ParticleOutput;
+
+template <> struct ParticleOutput<ExRootTreeBranch>
+{
+  typedef TRootGenParticle Particle;
+  static Particle *New(ExRootTreeBranch *branch) { return static_cast<Particle *>(branch->NewEntry()); }
+};
+
+template <> struct ParticleOutput< vector<ExRootGenParticle> >
+{
+  typedef ExRootGenParticle Particle;
+  static Particle *New(vector<Particle> *particles)
+  {
+    particles->push_back(Particle());
+    return &particles->back();
+  }
+};
+
+//---------------------------------------------------------------------------
+
 bool ExRootSTDHEPReader::ReadBlock(ExRootTreeBranch *branch)
 {
+  return Read(branch);
+}
+
+//---------------------------------------------------------------------------
+
+bool ExRootSTDHEPReader::ReadBlock(vector<ExRootGenParticle> &particles)
+{
+  return Read(&particles);
+}
+
+//---------------------------------------------------------------------------
+
+bool ExRootSTDHEPReader::ReadEvent(ExRootSTDHEPEventView &view)
+{
+  Clear();
+  fParticles.clear();
+
+  while(ReadBlock(fParticles))
+  {
+    if(!EventReady()) continue;
+
+    AnalyzeEvent(fEvent, ++fEventCounter);
+
+    view.event = &fEvent;
+    view.particles = ExRootSpan<ExRootGenParticle>(fParticles.empty() ? 0 : &fParticles[0], fParticles.size());
+
+    return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//---------------------------------------------------------------------------
+
+long long ExRootSTDHEPReader::ReadEvents(ExRootEventHandler<ExRootSTDHEPEventView> *handler)
+{
+  ExRootSTDHEPEventView view;
+  long long events = 0;
+
+  while(ReadEvent(view))
+  {
+    ++events;
+    if(!handler->ProcessEvent(view)) break;
+  }
+
+  return events;
+}
+
+//---------------------------------------------------------------------------
+
+template <typename T>
+bool ExRootSTDHEPReader::Read(T *output)
+{
+  EXROOT_PROFILE_SCOPE("ExRootSTDHEPReader::ReadBlock");
+
   if(feof(fInputFile)) return kFALSE;
 
   xdr_int(fInputXDR, &fBlockType);
@@ -100,12 +178,12 @@ bool ExRootSTDHEPReader::ReadBlock(ExRootTreeBranch *branch)
   else if(fBlockType == MCFIO_STDHEP)
   {
     ReadSTDHEP();
-    AnalyzeParticles(branch);
+    AnalyzeParticles(output);
   }
   else if(fBlockType == MCFIO_STDHEP4)
   {
     ReadSTDHEP();
-    AnalyzeParticles(branch);
+    AnalyzeParticles(output);
     ReadSTDHEP4();
   }
   else
@@ -400,12 +478,24 @@ void ExRootSTDHEPReader::ReadSTDHEP4()
 
 void ExRootSTDHEPReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber)
 {
-  TRootLHEFEvent *element;
+  FillEvent(static_cast<TRootLHEFEvent *>(branch->NewEntry()), eventNumber);
+}
+
+//---------------------------------------------------------------------------
+
+void ExRootSTDHEPReader::AnalyzeEvent(ExRootLHEFEvent &event, long long eventNumber)
+{
+  FillEvent(&event, eventNumber);
+}
 
-  element = static_cast<TRootLHEFEvent *>(branch->NewEntry());
+//---------------------------------------------------------------------------
 
+template <typename T>
+void ExRootSTDHEPReader::FillEvent(T *element, long long eventNumber)
+{
   element->Number = fEventNumber;
 
+  element->Nparticles = fEventSize;
   element->ProcessID = 0;
 
   element->Weight = fWeight;
@@ -416,9 +506,12 @@ void ExRootSTDHEPReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventN
 
 //---------------------------------------------------------------------------
 
-void ExRootSTDHEPReader::AnalyzeParticles(ExRootTreeBranch *branch)
+template <typename T>
+void ExRootSTDHEPReader::AnalyzeParticles(T *output)
 {
-  TRootGenParticle *element;
+  EXROOT_PROFILE_SCOPE("ExRootSTDHEPReader::AnalyzeParticles");
+
+  typename ParticleOutput<T>::Particle *element;
 
   Double_t signPz, cosTheta;
   TLorentzVector momentum;
@@ -456,7 +549,7 @@ void ExRootSTDHEPReader::AnalyzeParticles(ExRootTreeBranch *branch)
     xdr_double(&bufferXDR[5], &z);
     xdr_double(&bufferXDR[5], &t);
 
-    element = static_cast<TRootGenParticle*>(branch->NewEntry());
+    element = ParticleOutput<T>::New(output);
 
     element->PID = pid;
     element->Status = status;
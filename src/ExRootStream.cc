@@ -27,11 +27,11 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-bool ExRootStream::fFirstLongMin = true;
-bool ExRootStream::fFirstLongMax = true;
-bool ExRootStream::fFirstHugePos = true;
-bool ExRootStream::fFirstHugeNeg = true;
-bool ExRootStream::fFirstZero = true;
+atomic<bool> ExRootStream::fFirstLongMin(true);
+atomic<bool> ExRootStream::fFirstLongMax(true);
+atomic<bool> ExRootStream::fFirstHugePos(true);
+atomic<bool> ExRootStream::fFirstHugeNeg(true);
+atomic<bool> ExRootStream::fFirstZero(true);
 
 //------------------------------------------------------------------------------
 
@@ -51,19 +51,16 @@ bool ExRootStream::ReadDbl(double &value)
   {
     if(fFirstHugePos && value == HUGE_VAL)
     {
-      fFirstHugePos = false; 
-      cout << "** WARNING: too large positive value, return " << value << endl;
+      if(fFirstHugePos.exchange(false)) cout << "** WARNING: too large positive value, return " << value << endl;
     }
     else if(fFirstHugeNeg && value == -HUGE_VAL)
     {
-      fFirstHugeNeg = false; 
-      cout << "** WARNING: too large negative value, return " << value << endl;
+      if(fFirstHugeNeg.exchange(false)) cout << "** WARNING: too large negative value, return " << value << endl;
     }
     else if(fFirstZero)
     {
-      fFirstZero = false; 
       value = 0.0;
-      cout << "** WARNING: too small value, return " << value << endl;
+      if(fFirstZero.exchange(false)) cout << "** WARNING: too small value, return " << value << endl;
     }
   }
   return start != fBuffer;
@@ -80,13 +77,11 @@ bool ExRootStream::ReadInt(int &value)
   {
     if(fFirstLongMin && value == LONG_MIN)
     {
-      fFirstLongMin = false; 
-      cout << "** WARNING: too large positive value, return " << value << endl;
+      if(fFirstLongMin.exchange(false)) cout << "** WARNING: too large positive value, return " << value << endl;
     }
     else if(fFirstLongMax && value == LONG_MAX)
     {
-      fFirstLongMax = false; 
-      cout << "** WARNING: too large negative value, return " << value << endl;
+      if(fFirstLongMax.exchange(false)) cout << "** WARNING: too large negative value, return " << value << endl;
     }
   }
   return start != fBuffer;
@@ -13,6 +13,7 @@
 */
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
 
 #include "TFile.h"
 #include "TTree.h"
@@ -25,8 +26,8 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-ExRootTreeBranch::ExRootTreeBranch(const char *name, TClass *cl, TTree *tree) :
-  fSize(0), fCapacity(1), fData(0)
+ExRootTreeBranch::ExRootTreeBranch(const char *name, TClass *cl, TTree *tree, Bool_t reuse) :
+  fSize(0), fCapacity(1), fReuse(reuse), fData(0)
 {
 //  cl->IgnoreTObjectStreamer();
   fData = new TClonesArray(cl, fCapacity);
@@ -35,7 +36,9 @@ ExRootTreeBranch::ExRootTreeBranch(const char *name, TClass *cl, TTree *tree) :
   {
     fData->SetName(name);
     fData->ExpandCreateFast(fCapacity);
-    fData->Clear();
+    // the reused objects stay in the array, only the size is reset
+    if(fReuse) fData->SetLast(-1);
+    else fData->Clear();
     if(tree)
     {
       tree->Branch(name, &fData, 64000);
@@ -59,6 +62,8 @@ ExRootTreeBranch::~ExRootTreeBranch()
 
 TObject *ExRootTreeBranch::NewEntry()
 {
+  EXROOT_PROFILE_SCOPE("ExRootTreeBranch::NewEntry");
+
   if(!fData) return 0;
 
   if(fSize >= fCapacity)
@@ -71,8 +76,22 @@ TObject *ExRootTreeBranch::NewEntry()
 
     fData->ExpandCreateFast(fCapacity);
 
-    fData->Clear();
-    fData->ExpandCreateFast(fSize);
+    if(fReuse)
+    {
+      fData->SetLast(fSize - 1);
+    }
+    else
+    {
+      fData->Clear();
+      fData->ExpandCreateFast(fSize);
+    }
+  }
+
+  if(fReuse)
+  {
+    TObject *object = fData->UncheckedAt(fSize++);
+    fData->SetLast(fSize - 1);
+    return object;
   }
   
   return fData->AddrAt(fSize++);
@@ -83,7 +102,9 @@ TObject *ExRootTreeBranch::NewEntry()
 void ExRootTreeBranch::Clear()
 {
   fSize = 0;
-  if(fData) fData->Clear();
+  if(!fData) return;
+  if(fReuse) fData->SetLast(-1);
+  else fData->Clear();
 }
 
 //------------------------------------------------------------------------------
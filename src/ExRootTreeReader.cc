@@ -13,10 +13,7 @@
 
 #include "ExRootAnalysis/ExRootTreeReader.h"
 
-#include "TH2.h"
-#include "TStyle.h"
 #include "TFolder.h"
-#include "TCanvas.h"
 #include "TBrowser.h"
 #include "TClonesArray.h"
 #include "TBranchElement.h"
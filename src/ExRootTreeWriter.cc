@@ -13,18 +13,22 @@
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
 
 #include "TROOT.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TList.h"
 #include "TClonesArray.h"
 
 #include <iostream>
+#include <fstream>
 
 using namespace std;
 
 ExRootTreeWriter::ExRootTreeWriter(TFile *file, const char *treeName) :
-  fFile(file), fTree(0), fTreeName(treeName)
+  fFile(file), fTree(0), fTreeName(treeName),
+  fMaxBytes(0), fMaxEntries(0), fOwnFile(0)
 {
 }
 
@@ -39,14 +43,43 @@ ExRootTreeWriter::~ExRootTreeWriter()
   }
   
   if(fTree) delete fTree;
+
+  if(fOwnFile)
+  {
+    fOwnFile->Close();
+    delete fOwnFile;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::SetFileRotation(Long64_t maxBytes, Long64_t maxEntries, const char *fileList)
+{
+  fMaxBytes = maxBytes;
+  fMaxEntries = maxEntries;
+  fFileList = fileList ? fileList : "";
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::ChangeFile(TFile *file)
+{
+  fFile = file;
+
+  if(!fTree) return;
+
+  // the user information belongs to the previous file
+  fTree->Reset();
+  fTree->GetUserInfo()->Delete();
+  fTree->SetDirectory(file);
 }
 
 //------------------------------------------------------------------------------
 
-ExRootTreeBranch *ExRootTreeWriter::NewBranch(const char *name, TClass *cl)
+ExRootTreeBranch *ExRootTreeWriter::NewBranch(const char *name, TClass *cl, Bool_t reuse)
 {
   if(!fTree) fTree = NewTree();
-  ExRootTreeBranch *branch = new ExRootTreeBranch(name, cl, fTree);
+  ExRootTreeBranch *branch = new ExRootTreeBranch(name, cl, fTree, reuse);
   fBranches.insert(branch);
   return branch;
 }
@@ -62,17 +95,133 @@ ExRootTreeBranch *ExRootTreeWriter::NewFactory(const char *name, TClass *cl)
 
 //------------------------------------------------------------------------------
 
+TBranch *ExRootTreeWriter::NewLeaf(const char *name, void *address, const char *leafList)
+{
+  if(!fTree) fTree = NewTree();
+  if(!fTree) return 0;
+  return fTree->Branch(name, address, leafList);
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::AddUserInfo(TObject *object)
+{
+  if(!fTree) fTree = NewTree();
+  if(fTree) fTree->GetUserInfo()->Add(object);
+  else delete object;
+}
+
+//------------------------------------------------------------------------------
+
 void ExRootTreeWriter::Fill()
 {
-  if(fTree) fTree->Fill();
+  EXROOT_PROFILE_SCOPE("ExRootTreeWriter::Fill");
+
+  if(!fTree) return;
+
+  fTree->Fill();
+
+  if(fMaxBytes <= 0 && fMaxEntries <= 0) return;
+
+  // the cluster size is only known in entries after the first
+  // automatic flush of the tree
+
+  Long64_t entries = fTree->GetEntries();
+  Long64_t autoFlush = fTree->GetAutoFlush();
+
+  if(autoFlush <= 0 || entries % autoFlush != 0) return;
+
+  if((fMaxEntries > 0 && entries >= fMaxEntries) ||
+     (fMaxBytes > 0 && fTree->GetCurrentFile()->GetEND() >= fMaxBytes))
+  {
+    RotateFile();
+  }
 }
 
 //------------------------------------------------------------------------------
 
 void ExRootTreeWriter::Write()
 {
+  EXROOT_PROFILE_SCOPE("ExRootTreeWriter::Write");
+
   fFile = fTree ? fTree->GetCurrentFile() : 0;
   if(fFile) fFile->Write();
+
+  if(fFile && !fFileList.IsNull())
+  {
+    if(fFileNames.empty()) fFileNames.push_back(fFile->GetName());
+    WriteFileList();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::RotateFile()
+{
+  EXROOT_PROFILE_SCOPE("ExRootTreeWriter::RotateFile");
+
+  TFile *file = fTree->GetCurrentFile();
+  TFile *newFile;
+  TString name(file->GetName());
+  Ssiz_t dot = name.Last('.');
+  Ssiz_t slash = name.Last('/');
+
+  if(fFileNames.empty()) fFileNames.push_back(name);
+
+  if(dot > slash) name.Insert(dot, Form("_%d", Int_t(fFileNames.size())));
+  else name += Form("_%d", Int_t(fFileNames.size()));
+
+  // an existing file is not overwritten, as the converters
+  // refuse to overwrite the first one
+  newFile = TFile::Open(name, "CREATE", "", file->GetCompressionSettings());
+  if(!newFile || newFile->IsZombie())
+  {
+    cout << "** ERROR: cannot create file " << name << ", continue writing " << file->GetName() << endl;
+    delete newFile;
+    fMaxBytes = fMaxEntries = 0;
+    return;
+  }
+
+  // the finished file keeps the tree with its entries,
+  // the tree continues empty in the new file
+
+  TDirectory *dir = gDirectory;
+  file->cd();
+  fTree->Write();
+  fTree->Reset();
+  fTree->SetDirectory(newFile);
+  dir->cd();
+
+  // the first file belongs to the caller and stays open
+
+  if(fOwnFile)
+  {
+    fOwnFile->Close();
+    delete fOwnFile;
+  }
+  fOwnFile = newFile;
+  fFile = newFile;
+
+  fFileNames.push_back(name);
+  if(!fFileList.IsNull()) WriteFileList();
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::WriteFileList()
+{
+  ofstream outfile(fFileList);
+  vector<TString>::iterator itFileNames;
+
+  for(itFileNames = fFileNames.begin(); itFileNames != fFileNames.end(); ++itFileNames)
+  {
+    outfile << *itFileNames << endl;
+  }
+
+  if(!outfile.good())
+  {
+    cout << "** ERROR: cannot write file list " << fFileList << endl;
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -14,7 +14,6 @@
 #include "ExRootAnalysis/ExRootUtilities.h"
 
 #include "TROOT.h"
-#include "TH1.h"
 #include "TChain.h"
 
 #include <iostream>
@@ -22,39 +21,6 @@
 
 using namespace std;
 
-const Font_t kExRootFont = 42;
-const Float_t kExRootFontSize = 0.04; 
-
-void HistStyle(TH1 *hist, Bool_t stats)
-{
-  hist->SetLineWidth(2);
-  hist->SetLineColor(kBlack);
-  hist->SetMarkerStyle(kFullSquare);
-  hist->SetMarkerColor(kBlack);
-
-  hist->GetXaxis()->SetTitleOffset(1.5);
-  hist->GetYaxis()->SetTitleOffset(1.75);
-  hist->GetZaxis()->SetTitleOffset(1.5);
-
-  hist->GetXaxis()->SetTitleFont(kExRootFont);
-  hist->GetYaxis()->SetTitleFont(kExRootFont);
-  hist->GetZaxis()->SetTitleFont(kExRootFont);
-  hist->GetXaxis()->SetTitleSize(kExRootFontSize);
-  hist->GetYaxis()->SetTitleSize(kExRootFontSize);
-  hist->GetZaxis()->SetTitleSize(kExRootFontSize);
-  
-  hist->GetXaxis()->SetLabelFont(kExRootFont);
-  hist->GetYaxis()->SetLabelFont(kExRootFont);
-  hist->GetZaxis()->SetLabelFont(kExRootFont);
-  hist->GetXaxis()->SetLabelSize(kExRootFontSize);
-  hist->GetYaxis()->SetLabelSize(kExRootFontSize);
-  hist->GetZaxis()->SetLabelSize(kExRootFontSize);
-
-  hist->SetStats(stats);
-}
-
-//------------------------------------------------------------------------------
-
 Bool_t FillChain(TChain *chain, const char *inputFileList)
 {
   ifstream infile(inputFileList);
@@ -0,0 +1,738 @@
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <set>
+#include <map>
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "TROOT.h"
+
+#include "TFile.h"
+
+#include "ExRootAnalysis/ExRootLHEFReader.h"
+#include "ExRootAnalysis/ExRootSTDHEPReader.h"
+
+#include "ExRootAnalysis/ExRootTreeWriter.h"
+#include "ExRootAnalysis/ExRootEventSources.h"
+#include "ExRootAnalysis/ExRootEventSinks.h"
+#include "ExRootAnalysis/ExRootPipeline.h"
+#include "ExRootAnalysis/ExRootTimer.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+// set by the signal handler, read by all workers
+static atomic<bool> interrupted(false);
+
+void SignalHandler(int sig)
+{
+  interrupted = true;
+}
+
+//---------------------------------------------------------------------------
+
+// the sinks stop the pipeline at the next event after Ctrl-C,
+// not only between files
+
+class BatchLHEFSink: public ExRootLHEFTreeSink
+{
+public:
+  BatchLHEFSink(ExRootTreeWriter *treeWriter, ExRootLHEFReader *reader) :
+    ExRootLHEFTreeSink(treeWriter, reader) {}
+
+  Bool_t Write(ExRootLHEFEventData &data)
+  {
+    if(interrupted) return kFALSE;
+    return ExRootLHEFTreeSink::Write(data);
+  }
+};
+
+//---------------------------------------------------------------------------
+
+class BatchSTDHEPSink: public ExRootSTDHEPTreeSink
+{
+public:
+  BatchSTDHEPSink(ExRootTreeWriter *treeWriter) :
+    ExRootSTDHEPTreeSink(treeWriter) {}
+
+  Bool_t Write(ExRootSTDHEPEventData &data)
+  {
+    if(interrupted) return kFALSE;
+    return ExRootSTDHEPTreeSink::Write(data);
+  }
+};
+
+//---------------------------------------------------------------------------
+
+struct Job
+{
+  enum EFormat {kLHEF, kSTDHEP};
+
+  string input, output, error;
+  EFormat format;
+  Long64_t size, events;
+  Double_t seconds;
+  Int_t worker;
+};
+
+//---------------------------------------------------------------------------
+
+// one deque of jobs per worker, a worker takes the largest of its own
+// jobs first and steals the smallest job of the most loaded worker
+// when its own deque is empty
+
+class JobQueues
+{
+public:
+  JobQueues(vector<Job> &jobs, Int_t workers);
+
+  Job *Next(Int_t worker);
+
+private:
+  struct Queue
+  {
+    Queue() : bytes(0) {}
+    mutex lock;
+    deque<Job *> jobs;
+    Long64_t bytes;
+  };
+
+  vector<Queue> fQueues;
+};
+
+//---------------------------------------------------------------------------
+
+static bool LargerJob(const Job *a, const Job *b)
+{
+  return a->size > b->size;
+}
+
+//---------------------------------------------------------------------------
+
+JobQueues::JobQueues(vector<Job> &jobs, Int_t workers) :
+  fQueues(workers)
+{
+  vector<Job *> sorted;
+  vector<Job>::iterator itJobs;
+  vector<Job *>::iterator itSorted;
+  size_t i, lightest;
+
+  for(itJobs = jobs.begin(); itJobs != jobs.end(); ++itJobs) sorted.push_back(&(*itJobs));
+
+  // largest files first, each to the worker with the fewest bytes
+  stable_sort(sorted.begin(), sorted.end(), LargerJob);
+
+  for(itSorted = sorted.begin(); itSorted != sorted.end(); ++itSorted)
+  {
+    lightest = 0;
+    for(i = 1; i < fQueues.size(); ++i)
+    {
+      if(fQueues[i].bytes < fQueues[lightest].bytes) lightest = i;
+    }
+    fQueues[lightest].jobs.push_back(*itSorted);
+    fQueues[lightest].bytes += (*itSorted)->size;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+Job *JobQueues::Next(Int_t worker)
+{
+  Job *job = 0;
+  Long64_t bytes;
+  size_t i, victim;
+
+  {
+    lock_guard<mutex> lock(fQueues[worker].lock);
+    if(!fQueues[worker].jobs.empty())
+    {
+      job = fQueues[worker].jobs.front();
+      fQueues[worker].jobs.pop_front();
+      fQueues[worker].bytes -= job->size;
+      return job;
+    }
+  }
+
+  while(true)
+  {
+    // the remaining bytes are only a hint, the victim is checked again
+    // under its lock
+    victim = fQueues.size();
+    bytes = -1;
+    for(i = 0; i < fQueues.size(); ++i)
+    {
+      lock_guard<mutex> lock(fQueues[i].lock);
+      if(!fQueues[i].jobs.empty() && fQueues[i].bytes > bytes)
+      {
+        victim = i;
+        bytes = fQueues[i].bytes;
+      }
+    }
+
+    if(victim == fQueues.size()) return 0;
+
+    lock_guard<mutex> lock(fQueues[victim].lock);
+    if(fQueues[victim].jobs.empty()) continue;
+
+    job = fQueues[victim].jobs.back();
+    fQueues[victim].jobs.pop_back();
+    fQueues[victim].bytes -= job->size;
+    return job;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+// readers, writers and sinks of one thread, kept from file to file,
+// with a merged output all files of the thread go to the same trees
+
+class Worker
+{
+public:
+  Worker(Int_t index, const char *mergedFileName);
+  ~Worker();
+
+  void Run(JobQueues *queues);
+
+  Bool_t Good() const { return fError.empty(); }
+  const string &GetError() const { return fError; }
+
+private:
+  void Convert(Job *job);
+  void ConvertLHEF(Job *job, FILE *inputFile, TFile *outputFile);
+  void ConvertSTDHEP(Job *job, FILE *inputFile, TFile *outputFile);
+
+  Int_t fIndex;
+  string fError;
+
+  TFile *fMergedFile;
+
+  ExRootLHEFReader fLHEFReader;
+  ExRootSTDHEPReader fSTDHEPReader;
+
+  ExRootTreeWriter *fLHEFWriter, *fSTDHEPWriter;
+  BatchLHEFSink *fLHEFSink;
+  BatchSTDHEPSink *fSTDHEPSink;
+};
+
+//---------------------------------------------------------------------------
+
+Worker::Worker(Int_t index, const char *mergedFileName) :
+  fIndex(index), fMergedFile(0), fLHEFWriter(0), fSTDHEPWriter(0),
+  fLHEFSink(0), fSTDHEPSink(0)
+{
+  if(!mergedFileName) return;
+
+  fMergedFile = TFile::Open(mergedFileName, "CREATE");
+  if(!fMergedFile || fMergedFile->IsZombie())
+  {
+    fError = string("can't create output file ") + mergedFileName;
+    delete fMergedFile;
+    fMergedFile = 0;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+Worker::~Worker()
+{
+  // both trees are written at once with a merged output
+  if(fMergedFile) fMergedFile->Write();
+
+  delete fLHEFSink;
+  delete fSTDHEPSink;
+  delete fLHEFWriter;
+  delete fSTDHEPWriter;
+
+  if(fMergedFile)
+  {
+    fMergedFile->Close();
+    delete fMergedFile;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void Worker::Run(JobQueues *queues)
+{
+  Job *job;
+
+  if(!Good()) return;
+
+  while(!interrupted && (job = queues->Next(fIndex)))
+  {
+    job->worker = fIndex;
+    Convert(job);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void Worker::Convert(Job *job)
+{
+  ULong64_t start = ExRootTimer::Nanoseconds();
+  FILE *inputFile = 0;
+  TFile *outputFile = fMergedFile;
+
+  try
+  {
+    inputFile = fopen(job->input.c_str(), "r");
+    if(!inputFile) throw runtime_error("can't open " + job->input);
+
+    if(!fMergedFile)
+    {
+      outputFile = TFile::Open(job->output.c_str(), "CREATE");
+      if(!outputFile || outputFile->IsZombie())
+      {
+        delete outputFile;
+        outputFile = 0;
+        throw runtime_error("can't create output file " + job->output);
+      }
+    }
+
+    if(job->format == Job::kLHEF) ConvertLHEF(job, inputFile, outputFile);
+    else ConvertSTDHEP(job, inputFile, outputFile);
+  }
+  catch(runtime_error &e)
+  {
+    job->error = e.what();
+  }
+
+  // the trees stay with the worker, they are detached from a file
+  // of its own before it is closed
+
+  if(outputFile && outputFile != fMergedFile)
+  {
+    if(fLHEFWriter) fLHEFWriter->ChangeFile(0);
+    if(fSTDHEPWriter) fSTDHEPWriter->ChangeFile(0);
+    outputFile->Close();
+    delete outputFile;
+  }
+
+  if(inputFile) fclose(inputFile);
+
+  job->seconds = (ExRootTimer::Nanoseconds() - start)*1.0e-9;
+}
+
+//---------------------------------------------------------------------------
+
+void Worker::ConvertLHEF(Job *job, FILE *inputFile, TFile *outputFile)
+{
+  if(!fLHEFWriter)
+  {
+    fLHEFWriter = new ExRootTreeWriter(outputFile, "LHEF");
+    fLHEFSink = new BatchLHEFSink(fLHEFWriter, &fLHEFReader);
+  }
+  else if(!fMergedFile)
+  {
+    fLHEFWriter->ChangeFile(outputFile);
+  }
+
+  // the run information is stored again for every input file
+  fLHEFSink->Reset();
+  fLHEFWriter->Clear();
+
+  fLHEFReader.SetInputFile(inputFile);
+
+  ExRootLHEFSource source(&fLHEFReader);
+  ExRootPipeline<ExRootLHEFEventData> pipeline(&source, fLHEFSink);
+
+  try
+  {
+    pipeline.Run();
+  }
+  catch(runtime_error &)
+  {
+    fLHEFReader.SetInputFile(0);
+    fLHEFWriter->Clear();
+    throw;
+  }
+
+  // stops the decompression thread
+  fLHEFReader.SetInputFile(0);
+
+  job->events = fLHEFSink->GetEvents();
+  if(interrupted) job->error = "interrupted";
+
+  if(!fMergedFile) fLHEFWriter->Write();
+}
+
+//---------------------------------------------------------------------------
+
+void Worker::ConvertSTDHEP(Job *job, FILE *inputFile, TFile *outputFile)
+{
+  if(!fSTDHEPWriter)
+  {
+    fSTDHEPWriter = new ExRootTreeWriter(outputFile, "STDHEP");
+    fSTDHEPSink = new BatchSTDHEPSink(fSTDHEPWriter);
+  }
+  else if(!fMergedFile)
+  {
+    fSTDHEPWriter->ChangeFile(outputFile);
+  }
+
+  fSTDHEPSink->Reset();
+  fSTDHEPWriter->Clear();
+
+  fSTDHEPReader.SetInputFile(inputFile);
+
+  ExRootSTDHEPSource source(&fSTDHEPReader);
+  ExRootPipeline<ExRootSTDHEPEventData> pipeline(&source, fSTDHEPSink);
+
+  try
+  {
+    pipeline.Run();
+  }
+  catch(runtime_error &)
+  {
+    fSTDHEPWriter->Clear();
+    throw;
+  }
+
+  job->events = fSTDHEPSink->GetEvents();
+  if(interrupted) job->error = "interrupted";
+
+  if(!fMergedFile) fSTDHEPWriter->Write();
+}
+
+//---------------------------------------------------------------------------
+
+static Bool_t IsSTDHEP(const string &name)
+{
+  static const char *suffixes[] = {".hep", ".stdhep", ".xdr", 0};
+  const char **suffix;
+  size_t length;
+
+  for(suffix = suffixes; *suffix; ++suffix)
+  {
+    length = strlen(*suffix);
+    if(name.size() > length && name.compare(name.size() - length, length, *suffix) == 0) return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//---------------------------------------------------------------------------
+
+static string StripSuffix(const string &name)
+{
+  string result = name;
+  size_t slash = result.rfind('/'), position;
+
+  // run_01/file.lhe.gz -> run_01/file
+  position = result.find('.', slash == string::npos ? 0 : slash + 1);
+  if(position != string::npos && position > (slash == string::npos ? 0 : slash + 1)) result.erase(position);
+
+  return result;
+}
+
+//---------------------------------------------------------------------------
+
+static void SetOutputNames(vector<Job> &jobs, const string &directory)
+{
+  vector<Job>::iterator itJobs;
+  map<string, Int_t> counts;
+  map<string, string> prefixes;
+  map<string, string>::iterator itPrefixes;
+  set<string> used;
+  vector<string> names;
+  string name;
+  size_t position;
+  Int_t index;
+
+  // the output is named after the input file, inputs with the same name
+  // in different directories (Events/run_01/unweighted_events.lhe.gz,
+  // Events/run_02/...) are named after their path below the directory
+  // they have in common, run_01_unweighted_events.root, a name that is
+  // still taken gets the index of the input in the list
+
+  for(itJobs = jobs.begin(); itJobs != jobs.end(); ++itJobs)
+  {
+    name = itJobs->input;
+    position = name.rfind('/');
+    if(position != string::npos) name.erase(0, position + 1);
+    name = StripSuffix(name);
+    names.push_back(name);
+
+    itPrefixes = prefixes.find(name);
+    if(itPrefixes == prefixes.end())
+    {
+      prefixes[name] = itJobs->input;
+    }
+    else
+    {
+      string &prefix = itPrefixes->second;
+      for(position = 0; position < prefix.size() && position < itJobs->input.size() &&
+          prefix[position] == itJobs->input[position]; ++position);
+      prefix.erase(position);
+    }
+    ++counts[name];
+  }
+
+  for(itPrefixes = prefixes.begin(); itPrefixes != prefixes.end(); ++itPrefixes)
+  {
+    position = itPrefixes->second.rfind('/');
+    itPrefixes->second.erase(position == string::npos ? 0 : position + 1);
+  }
+
+  for(itJobs = jobs.begin(), index = 0; itJobs != jobs.end(); ++itJobs, ++index)
+  {
+    name = names[index];
+
+    if(counts[name] > 1)
+    {
+      name = StripSuffix(itJobs->input.substr(prefixes[name].size()));
+      replace(name.begin(), name.end(), '/', '_');
+    }
+
+    if(!used.insert(name).second)
+    {
+      name += Form("_%d", index);
+      used.insert(name);
+    }
+
+    itJobs->output = directory + "/" + name + ".root";
+  }
+}
+
+//---------------------------------------------------------------------------
+
+static string JSONString(const string &text)
+{
+  string result;
+  size_t i;
+
+  for(i = 0; i < text.size(); ++i)
+  {
+    switch(text[i])
+    {
+      case '"': result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\n': result += "\\n"; break;
+      case '\t': result += "\\t"; break;
+      default:
+        if((unsigned char)(text[i]) < 0x20) result += Form("\\u%04x", text[i]);
+        else result += text[i];
+    }
+  }
+
+  return result;
+}
+
+//---------------------------------------------------------------------------
+
+static void WriteReport(const vector<Job> &jobs, const char *fileName, Double_t seconds)
+{
+  vector<Job>::const_iterator itJobs;
+  Long64_t events = 0, bytes = 0;
+  FILE *file;
+
+  if(strcmp(fileName, "-") == 0)
+  {
+    file = stdout;
+  }
+  else
+  {
+    file = fopen(fileName, "w");
+    if(!file)
+    {
+      cerr << "** ERROR: can't open '" << fileName << "' for output" << endl;
+      return;
+    }
+  }
+
+  for(itJobs = jobs.begin(); itJobs != jobs.end(); ++itJobs)
+  {
+    events += itJobs->events;
+    bytes += itJobs->size;
+  }
+
+  if(seconds <= 0.0) seconds = 1.0e-9;
+
+  fprintf(file, "{\n");
+  fprintf(file, "  \"files\": %d,\n", Int_t(jobs.size()));
+  fprintf(file, "  \"events\": %lld,\n", events);
+  fprintf(file, "  \"bytes_read\": %lld,\n", bytes);
+  fprintf(file, "  \"seconds\": %.6f,\n", seconds);
+  fprintf(file, "  \"mb_read_per_second\": %.3f,\n", bytes/seconds*1.0e-6);
+  fprintf(file, "  \"inputs\": [\n");
+  for(itJobs = jobs.begin(); itJobs != jobs.end(); ++itJobs)
+  {
+    fprintf(file, "    {\"input\": \"%s\", \"output\": \"%s\", \"worker\": %d, \"events\": %lld, \"bytes_read\": %lld, \"seconds\": %.6f, \"error\": \"%s\"}%s\n",
+      JSONString(itJobs->input).c_str(), JSONString(itJobs->output).c_str(), itJobs->worker, itJobs->events,
+      itJobs->size, itJobs->seconds, JSONString(itJobs->error).c_str(),
+      itJobs + 1 != jobs.end() ? "," : "");
+  }
+  fprintf(file, "  ]\n");
+  fprintf(file, "}\n");
+
+  if(file != stdout) fclose(file);
+  else fflush(file);
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "ExRootBatchConverter";
+  stringstream message;
+  vector<Job> jobs;
+  vector<Job>::iterator itJobs;
+  vector<Worker *> workers;
+  vector<thread> threads;
+  string buffer, output;
+  const char *reportFileName = 0;
+  Bool_t merged = kFALSE;
+  Int_t i, failures = 0, workerCount = thread::hardware_concurrency();
+  struct stat status;
+  ULong64_t start;
+
+  if(argc < 3 || argc > 6)
+  {
+    cout << " Usage: " << appName << " input_file_list" << " output" << " [threads]" << " [mode]" << " [report_file]" << endl;
+    cout << " input_file_list - list of input files in LHEF (plain, gzip or zstd compressed)" << endl;
+    cout << "                   or STDHEP format (*.hep, *.stdhep, *.xdr), one per line," << endl;
+    cout << " output - output directory with mode 'files' (default), one ROOT file per input," << endl;
+    cout << "          with mode 'merged' the files of each thread are written" << endl;
+    cout << "          to output_0.root, output_1.root, ... listed in output.list," << endl;
+    cout << " threads - number of files converted in parallel (default: number of cores)," << endl;
+    cout << " mode - 'files' or 'merged'," << endl;
+    cout << " report_file - per-file timing in JSON format ('-' for stdout)." << endl;
+    return 1;
+  }
+
+  output = argv[2];
+  if(argc >= 4) workerCount = atoi(argv[3]);
+  if(argc >= 5)
+  {
+    if(strcmp(argv[4], "merged") == 0) merged = kTRUE;
+    else if(strcmp(argv[4], "files") != 0)
+    {
+      cerr << "** ERROR: unknown mode " << argv[4] << endl;
+      return 1;
+    }
+  }
+  if(argc >= 6 && argv[5][0] != '\0') reportFileName = argv[5];
+
+  signal(SIGINT, SignalHandler);
+
+  try
+  {
+    ifstream infile(argv[1]);
+    if(!infile.is_open())
+    {
+      message << "can't open " << argv[1];
+      throw runtime_error(message.str());
+    }
+
+    if(!merged && (stat(output.c_str(), &status) != 0 || !S_ISDIR(status.st_mode)))
+    {
+      message << "output directory " << output << " does not exist";
+      throw runtime_error(message.str());
+    }
+
+    while(infile >> buffer)
+    {
+      Job job;
+      job.input = buffer;
+      job.format = IsSTDHEP(buffer) ? Job::kSTDHEP : Job::kLHEF;
+      job.size = stat(buffer.c_str(), &status) == 0 ? status.st_size : 0;
+      job.events = 0;
+      job.seconds = 0.0;
+      job.worker = -1;
+      jobs.push_back(job);
+    }
+
+    if(!merged) SetOutputNames(jobs, output);
+
+    if(workerCount < 1) workerCount = 1;
+    if(workerCount > Int_t(jobs.size())) workerCount = jobs.size();
+
+    cout << "** Converting " << jobs.size() << " files using " << workerCount << " threads" << endl;
+
+    if(workerCount > 1) ROOT::EnableThreadSafety();
+
+    JobQueues queues(jobs, workerCount);
+
+    start = ExRootTimer::Nanoseconds();
+
+    for(i = 0; i < workerCount; ++i)
+    {
+      workers.push_back(new Worker(i, merged ? Form("%s_%d.root", output.c_str(), i) : 0));
+      if(!workers[i]->Good()) throw runtime_error(workers[i]->GetError());
+    }
+
+    for(i = 0; i < workerCount; ++i)
+    {
+      threads.push_back(thread(&Worker::Run, workers[i], &queues));
+    }
+
+    for(i = 0; i < workerCount; ++i)
+    {
+      threads[i].join();
+      delete workers[i];
+    }
+    workers.clear();
+
+    if(merged)
+    {
+      ofstream outfile((output + ".list").c_str());
+      for(i = 0; i < workerCount; ++i)
+      {
+        outfile << output << "_" << i << ".root" << endl;
+        for(itJobs = jobs.begin(); itJobs != jobs.end(); ++itJobs)
+        {
+          if(itJobs->worker == i) itJobs->output = Form("%s_%d.root", output.c_str(), i);
+        }
+      }
+    }
+
+    for(itJobs = jobs.begin(); itJobs != jobs.end(); ++itJobs)
+    {
+      if(itJobs->worker < 0)
+      {
+        if(itJobs->error.empty()) itJobs->error = "not converted";
+      }
+      else
+      {
+        cout << "** " << itJobs->input << ": " << itJobs->events << " events, "
+             << itJobs->seconds << " s, thread " << itJobs->worker << endl;
+      }
+
+      if(!itJobs->error.empty())
+      {
+        cerr << "** ERROR: " << itJobs->input << ": " << itJobs->error << endl;
+        ++failures;
+      }
+    }
+
+    if(reportFileName)
+    {
+      WriteReport(jobs, reportFileName, (ExRootTimer::Nanoseconds() - start)*1.0e-9);
+    }
+
+    cout << "** Exiting..." << endl;
+
+    return failures > 0 ? 1 : 0;
+  }
+  catch(runtime_error &e)
+  {
+    for(i = 0; i < Int_t(workers.size()); ++i) delete workers[i];
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
@@ -1,17 +1,15 @@
 
 #include <iostream>
 #include <utility>
+#include <vector>
 #include <deque>
 
-#include "TROOT.h"
-#include "TApplication.h"
-
 #include "TFile.h"
 #include "TTree.h"
 #include "TBranch.h"
 #include "TLeaf.h"
 #include "TString.h"
-#include "TLorentzVector.h"
+#include "TMath.h"
 
 #include "ExRootAnalysis/ExRootClasses.h"
 
@@ -19,9 +17,13 @@
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 #include "ExRootAnalysis/ExRootUtilities.h"
+#include "ExRootAnalysis/ExRootProgressBar.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
 
 using namespace std;
 
+static const Long64_t kCacheSize = 64*1024*1024;
+
 //------------------------------------------------------------------------------
 
 struct HEPEvent
@@ -109,6 +111,17 @@ HEPTreeReader::HEPTreeReader(TTree *tree, HEPEvent *event) : fChain(tree), fCurr
     branch->SetAddress(*floatData[i]);
     fBranches.push_back(make_pair(name, branch));
   }
+
+  // baskets of the used branches are prefetched in large blocks
+  // instead of being read one by one on demand
+
+  deque< pair<TString, TBranch*> >::iterator it_deque;
+
+  fChain->SetCacheSize(kCacheSize);
+  for(it_deque = fBranches.begin(); it_deque != fBranches.end(); ++it_deque)
+  {
+    fChain->AddBranchToCache(it_deque->first);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -178,6 +191,117 @@ void HEPTreeReader::Notify()
   }
 }
 
+//------------------------------------------------------------------------------
+
+struct HEPParticles
+{
+  void Resize(Int_t size)
+  {
+    if(size < 1) size = 1;
+    if(Int_t(status.size()) >= size) return;
+    status.resize(size); m1.resize(size); m2.resize(size); d1.resize(size); d2.resize(size);
+    pt.resize(size); eta.resize(size); phi.resize(size); rapidity.resize(size);
+  }
+
+  vector<Int_t> status, m1, m2, d1, d2;
+  vector<Double_t> pt, eta, phi, rapidity;
+};
+
+//------------------------------------------------------------------------------
+
+static void DecodeHistory(const HEPEvent &event, HEPParticles &particles)
+{
+  Int_t particle, size = event.Nhep;
+  const Int_t *jsmhep = event.Jsmhep, *jsdhep = event.Jsdhep;
+  Int_t *__restrict status = &particles.status[0];
+  Int_t *__restrict m1 = &particles.m1[0], *__restrict m2 = &particles.m2[0];
+  Int_t *__restrict d1 = &particles.d1[0], *__restrict d2 = &particles.d2[0];
+
+  // packed words are status*16000000 + first*4000 + second,
+  // divisions by constants compile into multiplications and shifts,
+  // the loop has no branches and no aliasing, so it is vectorized at -O3
+
+  for(particle = 0; particle < size; ++particle)
+  {
+    status[particle] = jsmhep[particle]/16000000 + jsdhep[particle]/16000000*100;
+    m1[particle] = (jsmhep[particle]%16000000)/4000 - 1;
+    m2[particle] = jsmhep[particle]%4000 - 1;
+    d1[particle] = (jsdhep[particle]%16000000)/4000 - 1;
+    d2[particle] = jsdhep[particle]%4000 - 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static void DecodeKinematics(const HEPEvent &event, HEPParticles &particles)
+{
+  Int_t particle, size = event.Nhep;
+  const Float_t *phep = event.Phep;
+  Double_t px, py, pz, e, p, cosTheta, signPz;
+
+  // same definitions as in TLorentzVector
+
+  for(particle = 0; particle < size; ++particle)
+  {
+    px = phep[particle*5 + 0];
+    py = phep[particle*5 + 1];
+    pz = phep[particle*5 + 2];
+    e = phep[particle*5 + 3];
+
+    p = TMath::Sqrt(px*px + py*py + pz*pz);
+    cosTheta = (p == 0.0) ? 1.0 : pz/p;
+    signPz = (pz >= 0.0) ? 1.0 : -1.0;
+
+    particles.pt[particle] = TMath::Sqrt(px*px + py*py);
+    particles.phi[particle] = (px == 0.0 && py == 0.0) ? 0.0 : TMath::ATan2(py, px);
+
+    if(TMath::Abs(cosTheta) == 1.0)
+    {
+      particles.eta[particle] = signPz*999.9;
+      particles.rapidity[particle] = signPz*999.9;
+    }
+    else
+    {
+      particles.eta[particle] = -0.5*TMath::Log((1.0 - cosTheta)/(1.0 + cosTheta));
+      particles.rapidity[particle] = 0.5*TMath::Log((e + pz)/(e - pz));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static void FillParticles(ExRootTreeBranch *branch, const HEPEvent &event, const HEPParticles &particles)
+{
+  Int_t particle, size = event.Nhep;
+  TRootGenParticle *element;
+
+  for(particle = 0; particle < size; ++particle)
+  {
+    element = static_cast<TRootGenParticle*>(branch->NewEntry());
+
+    element->PID = event.Idhep[particle];
+    element->Status = particles.status[particle];
+    element->M1 = particles.m1[particle];
+    element->M2 = particles.m2[particle];
+    element->D1 = particles.d1[particle];
+    element->D2 = particles.d2[particle];
+
+    element->E = event.Phep[particle*5 + 3];
+    element->Px = event.Phep[particle*5 + 0];
+    element->Py = event.Phep[particle*5 + 1];
+    element->Pz = event.Phep[particle*5 + 2];
+
+    element->PT = particles.pt[particle];
+    element->Phi = particles.phi[particle];
+    element->Eta = particles.eta[particle];
+    element->Rapidity = particles.rapidity[particle];
+
+    element->T = event.Vhep[particle*4 + 3];
+    element->X = event.Vhep[particle*4 + 0];
+    element->Y = event.Vhep[particle*4 + 1];
+    element->Z = event.Vhep[particle*4 + 2];
+  }
+}
 
 //------------------------------------------------------------------------------
 
@@ -193,12 +317,6 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  gROOT->SetBatch();
-
-  int appargc = 1;
-  char *appargv[] = {appName};
-  TApplication app(appName, &appargc, appargv);  
-
   TString inputFileList(argv[1]);
   TString outputFileName(argv[2]);
   string buffer;
@@ -219,63 +337,41 @@ int main(int argc, char *argv[])
   
     cout << "** Chain contains " << allEntries << " events" << endl;
   
-    Int_t address, particle;
-    Double_t signPz, cosTheta;
-  
-    TLorentzVector momentum;
-  
-    TRootGenParticle *element;
-  
+    HEPParticles particles;
+
+    ExRootProgressBar progressBar(allEntries);
+
     // Loop over all events
     for(entry = 0; entry < allEntries; ++entry)
     {
       // Load selected branches with data from specified event
+      progressBar.StartStage();
       treeReader->ReadEntry(entry);
       treeWriter->Clear();
-  
-      if((entry % 100) == 0 && entry > 0 )
-      {
-        cout << "** Processing element # " << entry << endl;
-      }
-  
-      for(particle = 0; particle < event.Nhep; ++particle)
-      {
-        element = (TRootGenParticle*) branchGen->NewEntry();
-  
-        element->PID = event.Idhep[particle];
-        element->Status = event.Jsmhep[particle]/16000000
-                        + event.Jsdhep[particle]/16000000*100;
-        element->M1 = (event.Jsmhep[particle]%16000000)/4000 - 1;
-        element->M2 = event.Jsmhep[particle]%4000 - 1;
-        element->D1 = (event.Jsdhep[particle]%16000000)/4000 - 1;
-        element->D2 = event.Jsdhep[particle]%4000 - 1;
-  
-        address = particle*5;
-        element->E = event.Phep[address + 3];
-        element->Px = event.Phep[address + 0];
-        element->Py = event.Phep[address + 1];
-        element->Pz = event.Phep[address + 2];
-  
-        momentum.SetPxPyPzE(element->Px, element->Py, element->Pz, element->E);
-
-        cosTheta = TMath::Abs(momentum.CosTheta());
-        signPz = (momentum.Pz() >= 0.0) ? 1.0 : -1.0;
-
-        element->PT = momentum.Perp();
-        element->Phi = momentum.Phi();
-        element->Eta = (cosTheta == 1.0 ? signPz*999.9 : momentum.Eta());
-        element->Rapidity = (cosTheta == 1.0 ? signPz*999.9 : momentum.Rapidity());
-
-        address = particle*4;
-        element->T = event.Vhep[address + 3];
-        element->X = event.Vhep[address + 0];
-        element->Y = event.Vhep[address + 1];
-        element->Z = event.Vhep[address + 2];
-      }
+      progressBar.StopStage(ExRootProgressBar::kParse);
+
+      progressBar.StartStage();
+      particles.Resize(event.Nhep);
+      DecodeHistory(event, particles);
+      DecodeKinematics(event, particles);
+      progressBar.StopStage(ExRootProgressBar::kKinematics);
+
+      progressBar.StartStage();
+      FillParticles(branchGen, event, particles);
       treeWriter->Fill();
+      progressBar.StopStage(ExRootProgressBar::kFill);
+
+      progressBar.Update(entry + 1, entry + 1);
     }
-  
+
+    progressBar.Update(allEntries, allEntries, kTRUE);
+    progressBar.Finish();
+
+    progressBar.StartStage();
     treeWriter->Write();
+    progressBar.StopStage(ExRootProgressBar::kCompress);
+
+    ExRootProfiler::Report();
   
     cout << "** Exiting..." << endl;
   
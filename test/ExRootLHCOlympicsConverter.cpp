@@ -1,14 +1,17 @@
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <stdlib.h>
 #include <signal.h>
+#include <string.h>
 #include <stdio.h>
 
-#include "TROOT.h"
-#include "TApplication.h"
-
 #include "TFile.h"
 #include "TLorentzVector.h"
 
@@ -17,11 +20,14 @@
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
+#include "ExRootAnalysis/ExRootColumnWriter.h"
 #include "ExRootAnalysis/ExRootProgressBar.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
 
 using namespace std;
 
 static const int kBufferSize  = 1024;
+static const int kChunkSize  = 4*1024*1024;
 
 /*
 LHC Olympics format discription from http://www.jthaler.net/olympicswiki/doku.php?id=lhc_olympics:data_file_format
@@ -38,6 +44,20 @@ LHC Olympics format discription from http://www.jthaler.net/olympicswiki/doku.ph
 
 //------------------------------------------------------------------------------
 
+struct LHCORow
+{
+  enum {kIntParamSize = 2, kDblParamSize = 7};
+
+  enum ERowType {kSkip, kEvent, kObject, kInvalidEvent, kInvalidObject};
+
+  Int_t type;
+  Int_t intParam[kIntParamSize];
+  Double_t dblParam[kDblParamSize];
+  Int_t eventNumber, triggerWord;
+};
+
+//------------------------------------------------------------------------------
+
 class LHCOConverter
 {
 public:
@@ -46,11 +66,26 @@ public:
 
   void Write();
 
-  Bool_t ReadLine(FILE *inputFile);
+  // optional columnar copy of PT, Eta, Phi and BTag of all objects
+  void SetColumnWriter(ExRootColumnWriter *writer);
+
+  // reads and parses the next line, kFALSE at the end of file
+  Bool_t ReadLine(FILE *inputFile, LHCORow &row);
+
+  // the parsing step may run in any thread, it only shares the
+  // warning flags of ExRootStream, the rows have to be processed
+  // in the file order
+
+  static void ParseRow(char *buffer, LHCORow &row);
+  Bool_t ProcessRow(const LHCORow &row);
+
+  // number of events filled into the tree
+  Long64_t GetEvents() const { return fEvents; }
 
 private:
 
   void AddMissingEvents();
+  void Fill();
 
   void AnalyseEvent(ExRootTreeBranch *branch);
 
@@ -61,7 +96,7 @@ private:
   void AnalyseJet(ExRootTreeBranch *branch);
   void AnalyseMissingET(ExRootTreeBranch *branch);
 
-  enum {kIntParamSize = 2, kDblParamSize = 7};
+  enum {kIntParamSize = LHCORow::kIntParamSize, kDblParamSize = LHCORow::kDblParamSize};
   Int_t fIntParam[kIntParamSize];
   Double_t fDblParam[kDblParamSize];
 
@@ -69,6 +104,8 @@ private:
 
   Int_t fTriggerWord, fEventNumber;
 
+  Long64_t fEvents;
+
   char *fBuffer;
 
   ExRootTreeWriter *fTreeWriter;
@@ -80,6 +117,9 @@ private:
   ExRootTreeBranch *fBranchTau;
   ExRootTreeBranch *fBranchJet;
   ExRootTreeBranch *fBranchMissingET;
+
+  ExRootColumnWriter *fColumnWriter;
+  Int_t fColumnCollection[7];
 };
 
 //------------------------------------------------------------------------------
@@ -87,7 +127,7 @@ private:
 LHCOConverter::LHCOConverter(TFile *outputFile) :
   fIsReadyToFill(kFALSE),
   fTriggerWord(0), fEventNumber(1),
-  fBuffer(0), fTreeWriter(0)
+  fEvents(0), fBuffer(0), fTreeWriter(0), fColumnWriter(0)
 {
   fBuffer = new char[kBufferSize];
   fTreeWriter = new ExRootTreeWriter(outputFile, "LHCO");
@@ -118,57 +158,87 @@ LHCOConverter::~LHCOConverter()
 
 //------------------------------------------------------------------------------
 
-Bool_t LHCOConverter::ReadLine(FILE *inputFile)
+Bool_t LHCOConverter::ReadLine(FILE *inputFile, LHCORow &row)
 {
-  int rc;
+  EXROOT_PROFILE_SCOPE("LHCOConverter::ReadLine");
 
   if(!fgets(fBuffer, kBufferSize, inputFile)) return kFALSE;
 
-  ExRootStream bufferStream(fBuffer);
+  ParseRow(fBuffer, row);
 
-  rc = bufferStream.ReadInt(fIntParam[0]);
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void LHCOConverter::ParseRow(char *buffer, LHCORow &row)
+{
+  int rc;
+
+  ExRootStream bufferStream(buffer);
+
+  rc = bufferStream.ReadInt(row.intParam[0]);
 
   if(!rc)
   {
-    return kTRUE;
+    row.type = LHCORow::kSkip;
+    return;
   }
 
-  if(fIntParam[0] == 0)
+  if(row.intParam[0] == 0)
   {
-    rc = bufferStream.ReadInt(fEventNumber)
-      && bufferStream.ReadInt(fTriggerWord);
+    rc = bufferStream.ReadInt(row.eventNumber)
+      && bufferStream.ReadInt(row.triggerWord);
 
-    if(!rc)
-    {
+    row.type = rc ? LHCORow::kEvent : LHCORow::kInvalidEvent;
+  }
+  else
+  {
+    rc = bufferStream.ReadInt(row.intParam[1])
+      && bufferStream.ReadDbl(row.dblParam[0])
+      && bufferStream.ReadDbl(row.dblParam[1])
+      && bufferStream.ReadDbl(row.dblParam[2])
+      && bufferStream.ReadDbl(row.dblParam[3])
+      && bufferStream.ReadDbl(row.dblParam[4])
+      && bufferStream.ReadDbl(row.dblParam[5])
+      && bufferStream.ReadDbl(row.dblParam[6]);
+
+    row.type = rc ? LHCORow::kObject : LHCORow::kInvalidObject;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t LHCOConverter::ProcessRow(const LHCORow &row)
+{
+  switch(row.type)
+  {
+    case LHCORow::kSkip:
+      return kTRUE;
+    case LHCORow::kInvalidEvent:
       cerr << "** ERROR: " << "invalid event format" << endl;
       return kFALSE;
-    }
+    case LHCORow::kInvalidObject:
+      cerr << "** ERROR: " << "invalid object format" << endl;
+      return kFALSE;
+  }
 
-    if(fIsReadyToFill && fTreeWriter)
-    {
-      fTreeWriter->Fill();
-      fTreeWriter->Clear();
-    }
+  memcpy(fIntParam, row.intParam, sizeof(fIntParam));
+  memcpy(fDblParam, row.dblParam, sizeof(fDblParam));
+
+  if(row.type == LHCORow::kEvent)
+  {
+    fEventNumber = row.eventNumber;
+    fTriggerWord = row.triggerWord;
+
+    if(fIsReadyToFill) Fill();
 
     AnalyseEvent(fBranchEvent);
     fIsReadyToFill = kTRUE;
   }
   else
   {
-    rc = bufferStream.ReadInt(fIntParam[1])
-      && bufferStream.ReadDbl(fDblParam[0])
-      && bufferStream.ReadDbl(fDblParam[1])
-      && bufferStream.ReadDbl(fDblParam[2])
-      && bufferStream.ReadDbl(fDblParam[3])
-      && bufferStream.ReadDbl(fDblParam[4])
-      && bufferStream.ReadDbl(fDblParam[5])
-      && bufferStream.ReadDbl(fDblParam[6]);
-
-    if(!rc)
-    {
-      cerr << "** ERROR: " << "invalid object format" << endl;
-      return kFALSE;
-    }
+    EXROOT_PROFILE_SCOPE("LHCOConverter::AnalyseObject");
 
     switch(fIntParam[1])
     {
@@ -179,6 +249,13 @@ Bool_t LHCOConverter::ReadLine(FILE *inputFile)
       case 4: AnalyseJet(fBranchJet); break;
       case 6: AnalyseMissingET(fBranchMissingET); break;
     }
+
+    if(fColumnWriter && fIntParam[1] >= 0 && fIntParam[1] <= 6 && fColumnCollection[fIntParam[1]] >= 0)
+    {
+      fColumnWriter->Add(fColumnCollection[fIntParam[1]], fDblParam[2],
+        fIntParam[1] == 6 ? 0.0 : fDblParam[0], fDblParam[1],
+        fIntParam[1] == 4 ? Int_t(fDblParam[5]) : 0);
+    }
   }
 
   return kTRUE;
@@ -186,9 +263,41 @@ Bool_t LHCOConverter::ReadLine(FILE *inputFile)
 
 //---------------------------------------------------------------------------
 
+void LHCOConverter::SetColumnWriter(ExRootColumnWriter *writer)
+{
+  const char *names[7] = {"Photon", "Electron", "Muon", "Tau", "Jet", 0, "MissingET"};
+  Int_t i;
+
+  fColumnWriter = writer;
+
+  for(i = 0; i < 7; ++i)
+  {
+    fColumnCollection[i] = (writer && names[i]) ? writer->NewCollection(names[i]) : -1;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void LHCOConverter::Fill()
+{
+  EXROOT_PROFILE_SCOPE("LHCOConverter::Fill");
+
+  if(fTreeWriter)
+  {
+    fTreeWriter->Fill();
+    fTreeWriter->Clear();
+  }
+
+  ++fEvents;
+
+  if(fColumnWriter) fColumnWriter->Fill();
+}
+
+//---------------------------------------------------------------------------
+
 void LHCOConverter::Write()
 {
-  if(fIsReadyToFill && fTreeWriter) fTreeWriter->Fill();
+  if(fIsReadyToFill) Fill();
   if(fTreeWriter) fTreeWriter->Write();
   fIsReadyToFill = kFALSE;
 }
@@ -316,6 +425,245 @@ void LHCOConverter::AnalyseMissingET(ExRootTreeBranch *branch)
 
 //---------------------------------------------------------------------------
 
+struct LHCOChunk
+{
+  vector<char> text;
+  vector<LHCORow> rows;
+  Long64_t end;
+  Bool_t ready;
+};
+
+//---------------------------------------------------------------------------
+
+class LHCOChunkParser
+{
+public:
+  LHCOChunkParser(FILE *inputFile, Int_t threads);
+  ~LHCOChunkParser();
+
+  // returns the next parsed chunk in the file order, 0 at the end of file,
+  // every chunk has to be given back with Release
+
+  LHCOChunk *NextChunk();
+  void Release(LHCOChunk *chunk);
+
+private:
+
+  void ReadChunk(LHCOChunk *chunk);
+  void Work();
+
+  static Bool_t IsEventHeader(const vector<char> &text, size_t position);
+  static void Parse(LHCOChunk *chunk);
+
+  FILE *fInputFile;
+  vector<char> fRemainder;
+  Long64_t fOffset;
+  Bool_t fEndOfFile, fStop;
+
+  size_t fMaxChunks;
+
+  mutex fMutex;
+  condition_variable fWorkCondition, fDoneCondition;
+
+  deque<LHCOChunk *> fChunks; // chunks in the file order
+  deque<LHCOChunk *> fQueue; // chunks waiting for a worker
+  vector<LHCOChunk *> fPool;
+
+  vector<thread> fWorkers;
+};
+
+//---------------------------------------------------------------------------
+
+LHCOChunkParser::LHCOChunkParser(FILE *inputFile, Int_t threads) :
+  fInputFile(inputFile), fOffset(0), fEndOfFile(kFALSE), fStop(kFALSE),
+  fMaxChunks(2*threads)
+{
+  Int_t i;
+  for(i = 0; i < threads; ++i)
+  {
+    fWorkers.push_back(thread(&LHCOChunkParser::Work, this));
+  }
+}
+
+//---------------------------------------------------------------------------
+
+LHCOChunkParser::~LHCOChunkParser()
+{
+  size_t i;
+
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fWorkCondition.notify_all();
+
+  for(i = 0; i < fWorkers.size(); ++i) fWorkers[i].join();
+
+  for(i = 0; i < fChunks.size(); ++i) delete fChunks[i];
+  for(i = 0; i < fPool.size(); ++i) delete fPool[i];
+}
+
+//---------------------------------------------------------------------------
+
+LHCOChunk *LHCOChunkParser::NextChunk()
+{
+  LHCOChunk *chunk;
+
+  unique_lock<mutex> lock(fMutex);
+
+  // keep the workers busy, only this thread reads the input file
+
+  while(!fEndOfFile && fChunks.size() < fMaxChunks)
+  {
+    if(fPool.empty())
+    {
+      chunk = new LHCOChunk;
+    }
+    else
+    {
+      chunk = fPool.back();
+      fPool.pop_back();
+    }
+
+    lock.unlock();
+    ReadChunk(chunk);
+    lock.lock();
+
+    fChunks.push_back(chunk);
+    fQueue.push_back(chunk);
+    fWorkCondition.notify_one();
+  }
+
+  if(fChunks.empty()) return 0;
+
+  chunk = fChunks.front();
+  fChunks.pop_front();
+
+  while(!chunk->ready) fDoneCondition.wait(lock);
+
+  return chunk;
+}
+
+//---------------------------------------------------------------------------
+
+void LHCOChunkParser::Release(LHCOChunk *chunk)
+{
+  lock_guard<mutex> lock(fMutex);
+  fPool.push_back(chunk);
+}
+
+//---------------------------------------------------------------------------
+
+Bool_t LHCOChunkParser::IsEventHeader(const vector<char> &text, size_t position)
+{
+  size_t size = text.size();
+
+  while(position < size && (text[position] == ' ' || text[position] == '\t')) ++position;
+
+  return position + 1 < size && text[position] == '0' &&
+    (text[position + 1] == ' ' || text[position + 1] == '\t');
+}
+
+//---------------------------------------------------------------------------
+
+void LHCOChunkParser::ReadChunk(LHCOChunk *chunk)
+{
+  vector<char> &text = chunk->text;
+  size_t size, split = 0;
+
+  text.swap(fRemainder);
+  fRemainder.clear();
+
+  // the chunk ends just before the last event header row,
+  // the rest of the text is kept for the next chunk
+
+  while(!split && !fEndOfFile)
+  {
+    size = text.size();
+    text.resize(size + kChunkSize);
+    size += fread(&text[size], 1, kChunkSize, fInputFile);
+    text.resize(size);
+
+    // a read error ends the input as well, main checks ferror
+    // after the last chunk and fails
+
+    if(feof(fInputFile) || ferror(fInputFile))
+    {
+      fEndOfFile = kTRUE;
+      split = size;
+      break;
+    }
+
+    for(split = size; split > 0; --split)
+    {
+      if(text[split - 1] == '\n' && IsEventHeader(text, split)) break;
+    }
+  }
+
+  fRemainder.assign(text.begin() + split, text.end());
+  text.resize(split);
+
+  fOffset += split;
+
+  chunk->end = fOffset;
+  chunk->ready = kFALSE;
+}
+
+//---------------------------------------------------------------------------
+
+void LHCOChunkParser::Parse(LHCOChunk *chunk)
+{
+  vector<char> &text = chunk->text;
+  LHCORow row;
+  size_t begin, end, size = text.size();
+
+  chunk->rows.clear();
+
+  text.push_back('\0');
+
+  // every row is terminated separately, so that a short row
+  // can not be completed with the numbers from the next row
+
+  for(begin = 0; begin < size; begin = end + 1)
+  {
+    for(end = begin; end < size && text[end] != '\n'; ++end);
+    text[end] = '\0';
+
+    LHCOConverter::ParseRow(&text[begin], row);
+    if(row.type == LHCORow::kSkip) continue;
+
+    chunk->rows.push_back(row);
+    if(row.type != LHCORow::kEvent && row.type != LHCORow::kObject) break;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void LHCOChunkParser::Work()
+{
+  LHCOChunk *chunk;
+
+  unique_lock<mutex> lock(fMutex);
+
+  while(true)
+  {
+    while(!fStop && fQueue.empty()) fWorkCondition.wait(lock);
+    if(fStop) break;
+
+    chunk = fQueue.front();
+    fQueue.pop_front();
+
+    lock.unlock();
+    Parse(chunk);
+    lock.lock();
+
+    chunk->ready = kTRUE;
+    fDoneCondition.notify_all();
+  }
+}
+
+//---------------------------------------------------------------------------
+
 static bool interrupted = false;
 
 void SignalHandler(int sig)
@@ -332,23 +680,30 @@ int main(int argc, char *argv[])
   FILE *inputFile = 0;
   TFile *outputFile = 0;
   LHCOConverter *converter = 0;
-  Long64_t length, eventCounter;
-
-  if(argc != 3)
+  ExRootColumnWriter *columnWriter = 0;
+  LHCOChunk *chunk;
+  LHCORow lineRow;
+  Long64_t length;
+  const char *summaryFileName = 0;
+  Int_t threads = 1;
+  size_t row;
+
+  if(argc < 3 || argc > 6)
   {
-    cout << " Usage: " << appName << " input_file" << " output_file" << endl;
+    cout << " Usage: " << appName << " input_file" << " output_file" << " [summary_file]" << " [threads]" << " [columns_file]" << endl;
     cout << " input_file - input file in LHEF format," << endl;
-    cout << " output_file - output file in ROOT format." << endl;
+    cout << " output_file - output file in ROOT format," << endl;
+    cout << " summary_file - throughput summary in JSON format ('-' for stdout, '' for none)," << endl;
+    cout << " threads - number of threads parsing the input (default 1)," << endl;
+    cout << " columns_file - PT, Eta, Phi and BTag of all objects for ExRootColumnReader." << endl;
     return 1;
   }
 
-  signal(SIGINT, SignalHandler);
-
-  gROOT->SetBatch();
+  if(argc >= 4 && argv[3][0] != '\0') summaryFileName = argv[3];
+  if(argc >= 5) threads = atoi(argv[4]);
+  if(threads < 1) threads = 1;
 
-  int appargc = 1;
-  char *appargv[] = {appName};
-  TApplication app(appName, &appargc, appargv);
+  signal(SIGINT, SignalHandler);
 
   try
   {
@@ -362,6 +717,12 @@ int main(int argc, char *argv[])
 
     converter = new LHCOConverter(outputFile);
 
+    if(argc == 6)
+    {
+      columnWriter = new ExRootColumnWriter(argv[5]);
+      converter->SetColumnWriter(columnWriter);
+    }
+
     cout << "** Reading " << argv[1] << endl;
     inputFile = fopen(argv[1], "r");
 
@@ -375,30 +736,96 @@ int main(int argc, char *argv[])
     length = ftello(inputFile);
     fseek(inputFile, 0L, SEEK_SET);
 
+    ExRootProgressBar progressBar(length);
+
     if(length > 0)
     {
-      eventCounter = 0;
-      ExRootProgressBar progressBar(length);
-
-      // Loop over all objects
-      while(converter->ReadLine(inputFile) && !interrupted)
+      if(threads > 1)
+      {
+        // Loop over chunks of events parsed in parallel
+        LHCOChunkParser parser(inputFile, threads);
+        Bool_t good = kTRUE;
+
+        progressBar.StartStage();
+        while(good && !interrupted && (chunk = parser.NextChunk()))
+        {
+          progressBar.StopStage(ExRootProgressBar::kParse);
+
+          progressBar.StartStage();
+          for(row = 0; good && row < chunk->rows.size(); ++row)
+          {
+            good = converter->ProcessRow(chunk->rows[row]);
+          }
+          progressBar.StopStage(ExRootProgressBar::kFill);
+
+          progressBar.Update(chunk->end, converter->GetEvents());
+          parser.Release(chunk);
+          progressBar.StartStage();
+        }
+      }
+      else
       {
-        ++eventCounter;
+        // Loop over all objects
+        Bool_t good = kTRUE;
 
-        progressBar.Update(ftello(inputFile), eventCounter);
+        progressBar.StartStage();
+        while(good && !interrupted && converter->ReadLine(inputFile, lineRow))
+        {
+          progressBar.StopStage(ExRootProgressBar::kParse);
+
+          progressBar.StartStage();
+          good = converter->ProcessRow(lineRow);
+          progressBar.StopStage(ExRootProgressBar::kFill);
+
+          progressBar.Update(ftello(inputFile), converter->GetEvents());
+          progressBar.StartStage();
+        }
       }
+
+      // the events read before a read error are kept in the tree
+      // (as after an interrupt), but the conversion fails
+
+      progressBar.StartStage();
       converter->Write();
+      progressBar.StopStage(ExRootProgressBar::kCompress);
+
+      if(ferror(inputFile))
+      {
+        message << "can't read " << argv[1] << ", the tree ends after ";
+        message << converter->GetEvents() << " events";
+        throw runtime_error(message.str());
+      }
 
       fseek(inputFile, 0L, SEEK_END);
-      progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
+      progressBar.Update(ftello(inputFile), converter->GetEvents(), kTRUE);
       progressBar.Finish();
     }
 
     fclose(inputFile);
 
+    if(columnWriter)
+    {
+      cout << "** Writing " << argv[5] << endl;
+      if(!columnWriter->Write())
+      {
+        message << "can't write " << argv[5];
+        throw runtime_error(message.str());
+      }
+    }
+
+    if(summaryFileName)
+    {
+      progressBar.SetBytesRead(length);
+      progressBar.SetBytesWritten(outputFile->GetBytesWritten());
+      progressBar.WriteSummary(summaryFileName);
+    }
+
+    ExRootProfiler::Report();
+
     cout << "** Exiting..." << endl;
 
     delete converter;
+    if(columnWriter) delete columnWriter;
     delete outputFile;
 
     return 0;
@@ -406,6 +833,7 @@ int main(int argc, char *argv[])
   catch(runtime_error &e)
   {
     if(converter) delete converter;
+    if(columnWriter) delete columnWriter;
     if(outputFile) delete outputFile;
     cerr << "** ERROR: " << e.what() << endl;
     return 1;
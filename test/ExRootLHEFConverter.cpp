@@ -3,9 +3,8 @@
 #include <sstream>
 
 #include <signal.h>
-
-#include "TROOT.h"
-#include "TApplication.h"
+#include <stdlib.h>
+#include <string.h>
 
 #include "TFile.h"
 #include "TLorentzVector.h"
@@ -16,6 +15,10 @@
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 #include "ExRootAnalysis/ExRootProgressBar.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
+#include "ExRootAnalysis/ExRootEventSources.h"
+#include "ExRootAnalysis/ExRootEventSinks.h"
+#include "ExRootAnalysis/ExRootPipeline.h"
 
 using namespace std;
 
@@ -30,6 +33,44 @@ void SignalHandler(int sig)
 
 //---------------------------------------------------------------------------
 
+class LHEFSink: public ExRootLHEFTreeSink
+{
+public:
+  LHEFSink(ExRootTreeWriter *treeWriter, ExRootLHEFReader *reader, ExRootProgressBar *progressBar, FILE *inputFile) :
+    ExRootLHEFTreeSink(treeWriter, reader), fProgressBar(progressBar), fInputFile(inputFile)
+  {
+  }
+
+  Bool_t Write(ExRootLHEFEventData &data)
+  {
+    Long64_t bytesWritten;
+
+    if(interrupted) return kFALSE;
+
+    fProgressBar->StartStage();
+    Copy(data);
+    fProgressBar->StopStage(ExRootProgressBar::kKinematics);
+
+    // baskets are compressed during Fill when the file grows
+    fProgressBar->StartStage();
+    Fill();
+    bytesWritten = TFile::GetFileBytesWritten();
+    fProgressBar->StopStage(bytesWritten > fProgressBar->GetBytesWritten() ?
+      ExRootProgressBar::kCompress : ExRootProgressBar::kFill);
+    fProgressBar->SetBytesWritten(bytesWritten);
+
+    fProgressBar->Update(ftello(fInputFile), GetEvents());
+
+    return kTRUE;
+  }
+
+private:
+  ExRootProgressBar *fProgressBar;
+  FILE *fInputFile;
+};
+
+//---------------------------------------------------------------------------
+
 int main(int argc, char *argv[])
 {
   char appName[] = "ExRootLHEFConverter";
@@ -37,25 +78,39 @@ int main(int argc, char *argv[])
   FILE *inputFile = 0;
   TFile *outputFile = 0;
   ExRootTreeWriter *treeWriter = 0;
-  ExRootTreeBranch *branchEvent = 0, *branchRwgt = 0, *branchParticle = 0;
   ExRootLHEFReader *reader = 0;
-  Long64_t length, eventCounter;
+  Long64_t length;
+  const char *summaryFileName = 0;
+  Long64_t maxFileSize = 0;
+  ExRootLHEFReader::EWeightStorage weightStorage = ExRootLHEFReader::kWeightObjects;
 
-  if(argc != 3)
+  if(argc < 3 || argc > 6)
   {
-    cout << " Usage: " << appName << " input_file" << " output_file" << endl;
-    cout << " input_file - input file in LHEF format," << endl;
-    cout << " output_file - output file in ROOT format." << endl;
+    cout << " Usage: " << appName << " input_file" << " output_file" << " [summary_file]" << " [max_file_size]" << " [weights]" << endl;
+    cout << " input_file - input file in LHEF format (plain, gzip or zstd compressed)," << endl;
+    cout << " output_file - output file in ROOT format," << endl;
+    cout << " summary_file - throughput summary in JSON format ('-' for stdout, '' for none)," << endl;
+    cout << " max_file_size - size in MB after which a new output file is started," << endl;
+    cout << "                 the list of files is written to output_file.list," << endl;
+    cout << " weights - 'objects' (default), 'double' or 'float', the array formats store" << endl;
+    cout << "           the weights declared in <initrwgt> as one Rwgt[n] leaf per event." << endl;
     return 1;
   }
 
-  signal(SIGINT, SignalHandler);
-
-  gROOT->SetBatch();
+  if(argc >= 4 && argv[3][0] != '\0') summaryFileName = argv[3];
+  if(argc >= 5) maxFileSize = atoll(argv[4])*1024*1024;
+  if(argc >= 6)
+  {
+    if(strcmp(argv[5], "double") == 0) weightStorage = ExRootLHEFReader::kWeightDouble;
+    else if(strcmp(argv[5], "float") == 0) weightStorage = ExRootLHEFReader::kWeightFloat;
+    else if(strcmp(argv[5], "objects") != 0)
+    {
+      cerr << "** ERROR: unknown weight format " << argv[5] << endl;
+      return 1;
+    }
+  }
 
-  int appargc = 1;
-  char *appargv[] = {appName};
-  TApplication app(appName, &appargc, appargv);
+  signal(SIGINT, SignalHandler);
 
   try
   {
@@ -68,12 +123,13 @@ int main(int argc, char *argv[])
     }
 
     treeWriter = new ExRootTreeWriter(outputFile, "LHEF");
-
-    branchEvent = treeWriter->NewBranch("Event", TRootLHEFEvent::Class());
-    branchRwgt = treeWriter->NewBranch("Rwgt", TRootWeight::Class());
-    branchParticle = treeWriter->NewBranch("Particle", TRootLHEFParticle::Class());
+    if(maxFileSize > 0)
+    {
+      treeWriter->SetFileRotation(maxFileSize, 0, TString(argv[2]) + ".list");
+    }
 
     reader = new ExRootLHEFReader;
+    reader->SetWeightStorage(weightStorage);
 
     cout << "** Reading " << argv[1] << endl;
     inputFile = fopen(argv[1], "r");
@@ -88,42 +144,45 @@ int main(int argc, char *argv[])
     length = ftello(inputFile);
     fseek(inputFile, 0L, SEEK_SET);
 
+    ExRootProgressBar progressBar(length);
+
+    LHEFSink sink(treeWriter, reader, &progressBar, inputFile);
+
     if(length > 0)
     {
       reader->SetInputFile(inputFile);
 
-      ExRootProgressBar progressBar(length);
+      // the events are parsed on a separate thread while the tree is filled
+      ExRootLHEFSource source(reader);
+      ExRootPipeline<ExRootLHEFEventData> pipeline(&source, &sink, 1);
 
-      // Loop over all objects
-      eventCounter = 0;
       treeWriter->Clear();
-      reader->Clear();
-      while(reader->ReadBlock(branchParticle) && !interrupted)
-      {
-        if(reader->EventReady())
-        {
-          ++eventCounter;
-
-          reader->AnalyzeEvent(branchEvent, eventCounter);
-          reader->AnalyzeRwgt(branchRwgt);
-
-          treeWriter->Fill();
+      pipeline.Run();
 
-          treeWriter->Clear();
+      progressBar.AddStage(ExRootProgressBar::kParse, source.GetCycles(), source.GetEvents());
 
-          reader->Clear();
-        }
-        progressBar.Update(ftello(inputFile), eventCounter);
-      }
+      // stops the decompression thread, also after an interrupt
+      reader->SetInputFile(0);
 
       fseek(inputFile, 0L, SEEK_END);
-      progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
+      progressBar.Update(ftello(inputFile), sink.GetEvents(), kTRUE);
       progressBar.Finish();
     }
 
     fclose(inputFile);
 
+    progressBar.StartStage();
     treeWriter->Write();
+    progressBar.StopStage(ExRootProgressBar::kCompress);
+
+    if(summaryFileName)
+    {
+      progressBar.SetBytesRead(length);
+      progressBar.SetBytesWritten(TFile::GetFileBytesWritten());
+      progressBar.WriteSummary(summaryFileName);
+    }
+
+    ExRootProfiler::Report();
 
     cout << "** Exiting..." << endl;
 
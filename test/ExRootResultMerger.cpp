@@ -0,0 +1,126 @@
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <stdlib.h>
+
+#include "TROOT.h"
+#include "TApplication.h"
+
+#include "ExRootAnalysis/ExRootResult.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+static void MergeFiles(ExRootResult *result, const vector<string> *fileNames,
+                       size_t first, size_t step, size_t *failures)
+{
+  size_t i;
+
+  for(i = first; i < fileNames->size(); i += step)
+  {
+    if(!result->Merge((*fileNames)[i].c_str())) ++(*failures);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "ExRootResultMerger";
+  stringstream message;
+  vector<string> fileNames;
+  string buffer;
+  size_t i, failures = 0;
+  int threads = 1;
+
+  if(argc < 3 || argc > 4)
+  {
+    cout << " Usage: " << appName << " input_file_list" << " output_file" << " [threads]" << endl;
+    cout << " input_file_list - list of files written by ExRootResult," << endl;
+    cout << " output_file - output file in ROOT format," << endl;
+    cout << " threads - number of files read in parallel (default 1)." << endl;
+    return 1;
+  }
+
+  if(argc == 4) threads = atoi(argv[3]);
+  if(threads < 1) threads = 1;
+
+  gROOT->SetBatch();
+
+  int appargc = 1;
+  char *appargv[] = {appName};
+  TApplication app(appName, &appargc, appargv);
+
+  try
+  {
+    ifstream infile(argv[1]);
+    if(!infile.is_open())
+    {
+      message << "can't open " << argv[1];
+      throw runtime_error(message.str());
+    }
+
+    while(infile >> buffer)
+    {
+      fileNames.push_back(buffer);
+    }
+
+    if(threads > Int_t(fileNames.size())) threads = fileNames.size();
+
+    cout << "** Merging " << fileNames.size() << " files using " << threads << " threads" << endl;
+
+    // each thread merges every n-th file into its own result,
+    // the partial results are combined at the end
+
+    vector<ExRootResult *> results(threads);
+    vector<size_t> threadFailures(threads, 0);
+    vector<thread> workers;
+
+    if(threads > 1) ROOT::EnableThreadSafety();
+
+    for(i = 0; i < results.size(); ++i)
+    {
+      results[i] = new ExRootResult;
+      workers.push_back(thread(MergeFiles, results[i], &fileNames, i, results.size(), &threadFailures[i]));
+    }
+
+    for(i = 0; i < workers.size(); ++i)
+    {
+      workers[i].join();
+      failures += threadFailures[i];
+    }
+
+    for(i = 1; i < results.size(); ++i)
+    {
+      results[0]->Merge(results[i]);
+      delete results[i];
+    }
+
+    if(failures > 0)
+    {
+      cerr << "** WARNING: " << failures << " files could not be merged" << endl;
+    }
+
+    if(!results.empty())
+    {
+      results[0]->Write(argv[2]);
+      delete results[0];
+    }
+
+    cout << "** Exiting..." << endl;
+
+    return failures > 0 ? 1 : 0;
+  }
+  catch(runtime_error &e)
+  {
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
+
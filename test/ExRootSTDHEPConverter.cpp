@@ -3,9 +3,7 @@
 #include <sstream>
 
 #include <signal.h>
-
-#include "TROOT.h"
-#include "TApplication.h"
+#include <stdlib.h>
 
 #include "TFile.h"
 #include "TLorentzVector.h"
@@ -16,6 +14,10 @@
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 #include "ExRootAnalysis/ExRootProgressBar.h"
+#include "ExRootAnalysis/ExRootProfiler.h"
+#include "ExRootAnalysis/ExRootEventSources.h"
+#include "ExRootAnalysis/ExRootEventSinks.h"
+#include "ExRootAnalysis/ExRootPipeline.h"
 
 using namespace std;
 
@@ -30,6 +32,44 @@ void SignalHandler(int sig)
 
 //---------------------------------------------------------------------------
 
+class STDHEPSink: public ExRootSTDHEPTreeSink
+{
+public:
+  STDHEPSink(ExRootTreeWriter *treeWriter, ExRootProgressBar *progressBar, FILE *inputFile) :
+    ExRootSTDHEPTreeSink(treeWriter), fProgressBar(progressBar), fInputFile(inputFile)
+  {
+  }
+
+  Bool_t Write(ExRootSTDHEPEventData &data)
+  {
+    Long64_t bytesWritten;
+
+    if(interrupted) return kFALSE;
+
+    fProgressBar->StartStage();
+    Copy(data);
+    fProgressBar->StopStage(ExRootProgressBar::kKinematics);
+
+    // baskets are compressed during Fill when the file grows
+    fProgressBar->StartStage();
+    Fill();
+    bytesWritten = TFile::GetFileBytesWritten();
+    fProgressBar->StopStage(bytesWritten > fProgressBar->GetBytesWritten() ?
+      ExRootProgressBar::kCompress : ExRootProgressBar::kFill);
+    fProgressBar->SetBytesWritten(bytesWritten);
+
+    fProgressBar->Update(ftello(fInputFile), GetEvents());
+
+    return kTRUE;
+  }
+
+private:
+  ExRootProgressBar *fProgressBar;
+  FILE *fInputFile;
+};
+
+//---------------------------------------------------------------------------
+
 int main(int argc, char *argv[])
 {
   char appName[] = "ExRootSTDHEPConverter";
@@ -37,25 +77,26 @@ int main(int argc, char *argv[])
   FILE *inputFile = 0;
   TFile *outputFile = 0;
   ExRootTreeWriter *treeWriter = 0;
-  ExRootTreeBranch *branchGenEvent = 0, *branchGenParticle = 0;
   ExRootSTDHEPReader *reader = 0;
-  Long64_t length, eventCounter;
+  Long64_t length;
+  const char *summaryFileName = 0;
+  Long64_t maxFileSize = 0;
 
-  if(argc != 3)
+  if(argc < 3 || argc > 5)
   {
-    cout << " Usage: " << appName << " input_file" << " output_file" << endl;
+    cout << " Usage: " << appName << " input_file" << " output_file" << " [summary_file]" << " [max_file_size]" << endl;
     cout << " input_file - input file in STDHEP format," << endl;
-    cout << " output_file - output file in ROOT format." << endl;
+    cout << " output_file - output file in ROOT format," << endl;
+    cout << " summary_file - throughput summary in JSON format ('-' for stdout, '' for none)," << endl;
+    cout << " max_file_size - size in MB after which a new output file is started," << endl;
+    cout << "                 the list of files is written to output_file.list." << endl;
     return 1;
   }
 
-  signal(SIGINT, SignalHandler);
-
-  gROOT->SetBatch();
+  if(argc >= 4 && argv[3][0] != '\0') summaryFileName = argv[3];
+  if(argc >= 5) maxFileSize = atoll(argv[4])*1024*1024;
 
-  int appargc = 1;
-  char *appargv[] = {appName};
-  TApplication app(appName, &appargc, appargv);
+  signal(SIGINT, SignalHandler);
 
   try
   {
@@ -68,11 +109,10 @@ int main(int argc, char *argv[])
     }
 
     treeWriter = new ExRootTreeWriter(outputFile, "STDHEP");
-
-    // information about generated event
-    branchGenEvent = treeWriter->NewBranch("Event", TRootLHEFEvent::Class());
-    // generated particles from HEPEVT
-    branchGenParticle = treeWriter->NewBranch("GenParticle", TRootGenParticle::Class());
+    if(maxFileSize > 0)
+    {
+      treeWriter->SetFileRotation(maxFileSize, 0, TString(argv[2]) + ".list");
+    }
 
     reader = new ExRootSTDHEPReader;
 
@@ -89,41 +129,42 @@ int main(int argc, char *argv[])
     length = ftello(inputFile);
     fseek(inputFile, 0L, SEEK_SET);
 
+    ExRootProgressBar progressBar(length);
+
+    STDHEPSink sink(treeWriter, &progressBar, inputFile);
+
     if(length > 0)
     {
       reader->SetInputFile(inputFile);
 
-      ExRootProgressBar progressBar(length);
+      // the file is read on a separate thread while the tree is filled
+      ExRootSTDHEPSource source(reader);
+      ExRootPipeline<ExRootSTDHEPEventData> pipeline(&source, &sink, 1);
 
-      // Loop over all objects
-      eventCounter = 0;
       treeWriter->Clear();
-      reader->Clear();
-      while(reader->ReadBlock(branchGenParticle) && !interrupted)
-      {
-        if(reader->EventReady())
-        {
-          ++eventCounter;
+      pipeline.Run();
 
-          reader->AnalyzeEvent(branchGenEvent, eventCounter);
-
-          treeWriter->Fill();
-
-          treeWriter->Clear();
-
-          reader->Clear();
-        }
-        progressBar.Update(ftello(inputFile), eventCounter);
-      }
+      progressBar.AddStage(ExRootProgressBar::kParse, source.GetCycles(), source.GetEvents());
 
       fseek(inputFile, 0L, SEEK_END);
-      progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
+      progressBar.Update(ftello(inputFile), sink.GetEvents(), kTRUE);
       progressBar.Finish();
     }
 
     fclose(inputFile);
 
+    progressBar.StartStage();
     treeWriter->Write();
+    progressBar.StopStage(ExRootProgressBar::kCompress);
+
+    if(summaryFileName)
+    {
+      progressBar.SetBytesRead(length);
+      progressBar.SetBytesWritten(TFile::GetFileBytesWritten());
+      progressBar.WriteSummary(summaryFileName);
+    }
+
+    ExRootProfiler::Report();
 
     cout << "** Exiting..." << endl;
 
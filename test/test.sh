@@ -2,6 +2,7 @@
 
 root -l -b <<- EOF
   gSystem->Load("../libExRootAnalysis.so");
+  gSystem->Load("../libExRootPlotting.so");
   .X Example.C("test.list");
   .q
 EOF